@@ -49,6 +49,8 @@
 #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_storing, &default_common }
 /* Example configuration for RPL non-storing mode: */
 /* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_ns, &default_common } */
+/* Example configuration for RPL storing mode with extra cells to the parent under load: */
+/* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_traffic_aware, &unicast_per_neighbor_rpl_storing, &default_common } */
 
 #endif /* ORCHESTRA_CONF_RULES */
 
@@ -72,6 +74,42 @@
 #define ORCHESTRA_UNICAST_PERIOD                  17
 #endif /* ORCHESTRA_CONF_UNICAST_PERIOD */
 
+#ifdef ORCHESTRA_CONF_TRAFFIC_PERIOD
+#define ORCHESTRA_TRAFFIC_PERIOD                  ORCHESTRA_CONF_TRAFFIC_PERIOD
+#else /* ORCHESTRA_CONF_TRAFFIC_PERIOD */
+#define ORCHESTRA_TRAFFIC_PERIOD                  13
+#endif /* ORCHESTRA_CONF_TRAFFIC_PERIOD */
+
+/* Traffic-aware unicast: the number of cells a node with children listens
+ * at in the slotframe, and the maximum number its children transmit at */
+#ifdef ORCHESTRA_CONF_TRAFFIC_MAX_CELLS
+#define ORCHESTRA_TRAFFIC_MAX_CELLS               ORCHESTRA_CONF_TRAFFIC_MAX_CELLS
+#else /* ORCHESTRA_CONF_TRAFFIC_MAX_CELLS */
+#define ORCHESTRA_TRAFFIC_MAX_CELLS               4
+#endif /* ORCHESTRA_CONF_TRAFFIC_MAX_CELLS */
+
+/* Traffic-aware unicast: how often the queue to the parent is sampled */
+#ifdef ORCHESTRA_CONF_TRAFFIC_INTERVAL
+#define ORCHESTRA_TRAFFIC_INTERVAL                ORCHESTRA_CONF_TRAFFIC_INTERVAL
+#else /* ORCHESTRA_CONF_TRAFFIC_INTERVAL */
+#define ORCHESTRA_TRAFFIC_INTERVAL                (2 * CLOCK_SECOND)
+#endif /* ORCHESTRA_CONF_TRAFFIC_INTERVAL */
+
+/* Traffic-aware unicast: a Tx cell is added when the average queue to the
+ * parent, weighted by ETX, exceeds HIGH packets per cell, and removed when it
+ * would stay under LOW packets per remaining cell */
+#ifdef ORCHESTRA_CONF_TRAFFIC_HIGH_THRESHOLD
+#define ORCHESTRA_TRAFFIC_HIGH_THRESHOLD          ORCHESTRA_CONF_TRAFFIC_HIGH_THRESHOLD
+#else /* ORCHESTRA_CONF_TRAFFIC_HIGH_THRESHOLD */
+#define ORCHESTRA_TRAFFIC_HIGH_THRESHOLD          2
+#endif /* ORCHESTRA_CONF_TRAFFIC_HIGH_THRESHOLD */
+
+#ifdef ORCHESTRA_CONF_TRAFFIC_LOW_THRESHOLD
+#define ORCHESTRA_TRAFFIC_LOW_THRESHOLD           ORCHESTRA_CONF_TRAFFIC_LOW_THRESHOLD
+#else /* ORCHESTRA_CONF_TRAFFIC_LOW_THRESHOLD */
+#define ORCHESTRA_TRAFFIC_LOW_THRESHOLD           1
+#endif /* ORCHESTRA_CONF_TRAFFIC_LOW_THRESHOLD */
+
 /* Is the per-neighbor unicast slotframe sender-based (if not, it is receiver-based).
  * Note: sender-based works only with RPL storing mode as it relies on DAO and
  * routing entries to keep track of children and parents. */
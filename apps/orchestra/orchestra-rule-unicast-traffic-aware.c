@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *         Orchestra: a slotframe of extra unicast cells, allocated according to
+ *         the traffic towards the RPL parent. Designed for RPL storing mode only.
+ *           Nodes with at least one child listen at all ORCHESTRA_TRAFFIC_MAX_CELLS
+ *           timeslots hash(MAC) + k * stride
+ *           Nodes transmit to their preferred parent at the first timeslots of
+ *           the parent, the more the longer their (ETX-weighted) queue to it,
+ *           once the parent has ACKed one of their DAOs
+ *         Data packets to the parent are not pinned to this slotframe: they may
+ *         still go at the parent's cell of the other unicast rules, which it
+ *         always serves. RPL control traffic is left to these rules.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/link-stats.h"
+#include "net/packetbuf.h"
+#include "net/ip/uip.h"
+#include <string.h>
+
+/*
+ * The body of this rule should be compiled only when "nbr_routes" is available,
+ * otherwise a link error causes build failure. "nbr_routes" is compiled if
+ * UIP_CONF_MAX_ROUTES != 0. See uip-ds6-route.c.
+ */
+#if UIP_CONF_MAX_ROUTES != 0
+
+/* EWMA of the queue to the parent, weighted by ETX */
+#define EWMA_SCALE            100
+#define EWMA_ALPHA             30
+
+#define TRAFFIC_STRIDE ((ORCHESTRA_TRAFFIC_PERIOD / ORCHESTRA_TRAFFIC_MAX_CELLS) > 0 ? \
+                        (ORCHESTRA_TRAFFIC_PERIOD / ORCHESTRA_TRAFFIC_MAX_CELLS) : 1)
+
+static uint16_t slotframe_handle = 0;
+static uint16_t channel_offset = 0;
+static struct tsch_slotframe *sf_traffic;
+static struct ctimer traffic_timer;
+static linkaddr_t parent_linkaddr;
+/* Number of cells we transmit at to our parent */
+static uint8_t tx_cells;
+/* Queue to the parent times ETX, in LINK_STATS_ETX_DIVISOR units */
+static uint32_t load_avg;
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_node_timeslot(const linkaddr_t *addr, uint8_t cell)
+{
+  return (ORCHESTRA_LINKADDR_HASH(addr) + cell * TRAFFIC_STRIDE) % ORCHESTRA_TRAFFIC_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_children(void)
+{
+  return nbr_table_head(nbr_routes) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_parent(void)
+{
+  return !linkaddr_cmp(&parent_linkaddr, &linkaddr_null);
+}
+/*---------------------------------------------------------------------------*/
+/* Add, update or remove the links of the slotframe so that they match the
+ * current number of Rx and Tx cells */
+static void
+update_links(void)
+{
+  uint8_t options[ORCHESTRA_TRAFFIC_PERIOD];
+  uint8_t rx_cells = has_children() ? ORCHESTRA_TRAFFIC_MAX_CELLS : 0;
+  uint16_t timeslot;
+  uint8_t i;
+
+  memset(options, 0, sizeof(options));
+  for(i = 0; i < rx_cells; i++) {
+    options[get_node_timeslot(&linkaddr_node_addr, i)] |= LINK_OPTION_RX;
+  }
+  for(i = 0; i < tx_cells; i++) {
+    options[get_node_timeslot(&parent_linkaddr, i)] |= LINK_OPTION_TX | LINK_OPTION_SHARED;
+  }
+
+  for(timeslot = 0; timeslot < ORCHESTRA_TRAFFIC_PERIOD; timeslot++) {
+    struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf_traffic, timeslot);
+    /* Tx cells are dedicated to the parent, so that the link selector only
+     * hands them packets to it */
+    const linkaddr_t *addr = (options[timeslot] & LINK_OPTION_TX) ? &parent_linkaddr : &tsch_broadcast_address;
+    if(options[timeslot] == 0) {
+      if(l != NULL) {
+        tsch_schedule_remove_link(sf_traffic, l);
+      }
+    } else if(l == NULL || l->link_options != options[timeslot]
+              || !linkaddr_cmp(&l->addr, addr)) {
+      tsch_schedule_add_link(sf_traffic, options[timeslot], LINK_TYPE_NORMAL, addr,
+                             timeslot, channel_offset);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Sample the queue to the parent and add or remove a Tx cell, with hysteresis */
+static void
+update_tx_cells(void)
+{
+  const struct link_stats *stats;
+  uint32_t load;
+  int count;
+
+  if(!has_parent() || !orchestra_parent_knows_us) {
+    /* The parent listens at all our cells as soon as it has a child, which
+     * it has once it received one of our DAOs */
+    tx_cells = 0;
+    load_avg = 0;
+    return;
+  }
+
+  count = tsch_queue_packet_count(&parent_linkaddr);
+  if(count < 0) {
+    /* TSCH is busy, sample again next time */
+    return;
+  }
+  stats = link_stats_from_lladdr(&parent_linkaddr);
+  load = (uint32_t)count * (stats != NULL ? stats->etx : LINK_STATS_ETX_DIVISOR);
+  load_avg = (load_avg * (EWMA_SCALE - EWMA_ALPHA) + load * EWMA_ALPHA) / EWMA_SCALE;
+
+  if(tx_cells == 0) {
+    tx_cells = 1;
+  } else if(tx_cells < ORCHESTRA_TRAFFIC_MAX_CELLS
+            && load_avg > (uint32_t)tx_cells * ORCHESTRA_TRAFFIC_HIGH_THRESHOLD
+                          * LINK_STATS_ETX_DIVISOR) {
+    tx_cells++;
+  } else if(tx_cells > 1
+            && load_avg < (uint32_t)(tx_cells - 1) * ORCHESTRA_TRAFFIC_LOW_THRESHOLD
+                          * LINK_STATS_ETX_DIVISOR) {
+    tx_cells--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+traffic_timer_callback(void *ptr)
+{
+  update_tx_cells();
+  update_links();
+  ctimer_reset(&traffic_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+child_added(const linkaddr_t *linkaddr)
+{
+  update_links();
+}
+/*---------------------------------------------------------------------------*/
+static void
+child_removed(const linkaddr_t *linkaddr)
+{
+  update_links();
+}
+/*---------------------------------------------------------------------------*/
+static int
+select_packet(uint16_t *slotframe, uint16_t *timeslot)
+{
+  /* Let data packets to our parent use our cells to it as well as any other
+   * link to it, once we have cells to it. RPL control packets are left to
+   * the next rules. */
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  if(packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_DATAFRAME
+     && packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID) != UIP_PROTO_ICMP6
+     && tx_cells > 0 && has_parent() && linkaddr_cmp(dest, &parent_linkaddr)) {
+    if(slotframe != NULL) {
+      *slotframe = 0xffff;
+    }
+    if(timeslot != NULL) {
+      *timeslot = 0xffff;
+    }
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new)
+{
+  if(new != old) {
+    if(new != NULL) {
+      linkaddr_copy(&parent_linkaddr, &new->addr);
+    } else {
+      linkaddr_copy(&parent_linkaddr, &linkaddr_null);
+    }
+    /* Start over with the new parent, once it knows about us */
+    tx_cells = 0;
+    load_avg = 0;
+    update_links();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  channel_offset = sf_handle;
+  linkaddr_copy(&parent_linkaddr, &linkaddr_null);
+  tx_cells = 0;
+  load_avg = 0;
+  /* Slotframe for the extra unicast cells, empty until we get children or
+   * a parent */
+  sf_traffic = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_TRAFFIC_PERIOD);
+  ctimer_set(&traffic_timer, ORCHESTRA_TRAFFIC_INTERVAL, traffic_timer_callback, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_traffic_aware = {
+  init,
+  new_time_source,
+  select_packet,
+  child_added,
+  child_removed,
+};
+
+#endif /* UIP_CONF_MAX_ROUTES != 0 */
@@ -58,8 +58,17 @@ PROCESS_THREAD(shell_ps_process, ev, data)
   shell_output_str(&ps_command, "Processes:", "");
   for(p = PROCESS_LIST(); p != NULL; p = p->next) {
     char namebuf[30];
+#if PROCESS_CONF_COUNTERS
+    char countbuf[40];
+#endif
     strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf));
+#if PROCESS_CONF_COUNTERS
+    snprintf(countbuf, sizeof(countbuf), " (%u events, %u polls)",
+             p->nevents, p->npolls);
+    shell_output_str(&ps_command, namebuf, countbuf);
+#else
     shell_output_str(&ps_command, namebuf, "");
+#endif
   }
 
   PROCESS_END();
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *         Shell interface to the receiver statistics and the runtime
+ *         configuration of the traffic app
+ * \author
+ *         Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#include "shell.h"
+#include "traffic-stats.h"
+#if TRAFFIC_RUNTIME_CONFIG
+#include "traffic-config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#define BUFLEN 128
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_traffic_stats_process, "traffic-stats");
+SHELL_COMMAND(traffic_stats_command,
+	      "traffic-stats",
+	      "traffic-stats [reset]: show or clear the per-source traffic statistics",
+	      &shell_traffic_stats_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_traffic_stats_process, ev, data)
+{
+  char buf[BUFLEN];
+  char prefix[16];
+  struct traffic_stats *s;
+
+  PROCESS_BEGIN();
+
+  if(data != NULL && strcmp(data, "reset") == 0) {
+    traffic_stats_reset();
+    PROCESS_EXIT();
+  }
+
+  for(s = traffic_stats_next(NULL); s != NULL; s = traffic_stats_next(s)) {
+    traffic_stats_format(buf, sizeof(buf), s);
+    shell_output_str(&traffic_stats_command, "", buf);
+    snprintf(prefix, sizeof(prefix), "%04x/%u iat ", s->origin, s->flow);
+    traffic_stats_format_histogram(buf, sizeof(buf), s->arrival,
+                                   TRAFFIC_STATS_ARRIVAL_BINS);
+    shell_output_str(&traffic_stats_command, prefix, buf);
+    if(s->received > 0) {
+      snprintf(prefix, sizeof(prefix), "%04x/%u lat ", s->origin, s->flow);
+      traffic_stats_format_histogram(buf, sizeof(buf), s->latency,
+                                     TRAFFIC_STATS_LATENCY_BINS);
+      shell_output_str(&traffic_stats_command, prefix, buf);
+    }
+  }
+  snprintf(buf, sizeof(buf), "%lu", (unsigned long)traffic_stats_evicted);
+  shell_output_str(&traffic_stats_command, "evicted ", buf);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+#if TRAFFIC_RUNTIME_CONFIG
+PROCESS(shell_traffic_config_process, "traffic-config");
+SHELL_COMMAND(traffic_config_command,
+	      "traffic-config",
+	      "traffic-config [<key> <value>|save]: show or change the traffic generator configuration",
+	      &shell_traffic_config_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_traffic_config_process, ev, data)
+{
+  char buf[BUFLEN];
+  const char *value;
+  int i;
+
+  PROCESS_BEGIN();
+
+  if(data != NULL && *(char *)data != '\0') {
+    if(strcmp(data, "save") == 0) {
+      if(traffic_config_save() < 0) {
+        shell_output_str(&traffic_config_command, "save failed", "");
+      }
+    } else {
+      value = strchr(data, ' ');
+      i = value == NULL ? strlen(data) : value - (char *)data;
+      if(i >= sizeof(buf)) {
+        i = sizeof(buf) - 1;
+      }
+      memcpy(buf, data, i);
+      buf[i] = '\0';
+      while(value != NULL && *value == ' ') {
+        value++;
+      }
+      if(value == NULL || traffic_config_set(buf, value) < 0) {
+        shell_output_str(&traffic_config_command, "invalid setting: ", data);
+      }
+    }
+  }
+
+  traffic_config_format(buf, sizeof(buf));
+  shell_output_str(&traffic_config_command, "", buf);
+  for(i = 0; i < traffic_config.destinations_count; i++) {
+    shell_output_str(&traffic_config_command, "dest ", traffic_config.destinations[i]);
+  }
+
+  PROCESS_END();
+}
+#endif /* TRAFFIC_RUNTIME_CONFIG */
+/*---------------------------------------------------------------------------*/
+void
+shell_traffic_init(void)
+{
+  shell_register_command(&traffic_stats_command);
+#if TRAFFIC_RUNTIME_CONFIG
+  shell_register_command(&traffic_config_command);
+#endif
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *         Shell interface to the receiver statistics and the runtime
+ *         configuration of the traffic app
+ * \author
+ *         Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef SHELL_TRAFFIC_H
+#define SHELL_TRAFFIC_H
+
+void shell_traffic_init(void);
+
+#endif /* SHELL_TRAFFIC_H */
@@ -405,6 +405,7 @@ struct shell_input {
 #include "shell-tcpsend.h"
 #include "shell-text.h"
 #include "shell-time.h"
+#include "shell-traffic.h"
 #include "shell-udpsend.h"
 #include "shell-vars.h"
 #include "shell-wget.h"
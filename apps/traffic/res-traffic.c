@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *       CoAP resource of the runtime configuration of the traffic
+ *       generator. GET returns the configuration as text; POST or PUT
+ *       change it with the keys of traffic_config_set() as form variables,
+ *       e.g. dist=exponential&interval=2000, plus save=1 to persist it.
+ *       Activate it with rest_activate_resource(&res_traffic, "traffic").
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ *
+ */
+
+#include "contiki.h"
+
+#if TRAFFIC_RUNTIME_CONFIG
+
+#include "traffic-conf.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "rest-engine.h"
+#include "traffic-config.h"
+
+#define TEXT_LEN (80 + TRAFFIC_CONFIG_MAX_DESTINATIONS * TRAFFIC_CONFIG_ADDRESS_LEN)
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+static void res_post_put_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_traffic,
+         "title=\"Traffic generator: POST/PUT dist, interval, deviation, probability, port, size, dest, save\";rt=\"Control\"",
+         res_get_handler,
+         res_post_put_handler,
+         res_post_put_handler,
+         NULL);
+
+static const char *keys[] = {
+  "dist", "interval", "deviation", "probability", "port", "size", "dest", NULL
+};
+
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  static char text[TEXT_LEN];
+  int total;
+  int len;
+  int i;
+
+  total = traffic_config_format(text, sizeof(text));
+  for(i = 0; i < traffic_config.destinations_count && total < sizeof(text); i++) {
+    total += snprintf(text + total, sizeof(text) - total, "%s%s",
+                      i ? "," : "\ndest ", traffic_config.destinations[i]);
+  }
+  total = strlen(text);
+
+  /* The text exceeds a block: serve the part at the requested offset */
+  if(*offset >= total) {
+    REST.set_response_status(response, REST.status.BAD_OPTION);
+    return;
+  }
+  len = total - *offset;
+  if(len > preferred_size) {
+    len = preferred_size;
+  }
+  memcpy(buffer, text + *offset, len);
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  REST.set_response_payload(response, buffer, len);
+  *offset += len;
+  if(*offset >= total) {
+    *offset = -1;
+  }
+}
+
+static void
+res_post_put_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  static char value[TRAFFIC_CONFIG_MAX_DESTINATIONS * TRAFFIC_CONFIG_ADDRESS_LEN];
+  const char *variable;
+  size_t len;
+  int i;
+
+  /* All the keys are checked before any of them is applied */
+  traffic_config_begin();
+  for(i = 0; keys[i] != NULL; i++) {
+    if((len = REST.get_post_variable(request, keys[i], &variable))) {
+      if(len >= sizeof(value)) {
+        REST.set_response_status(response, REST.status.BAD_REQUEST);
+        return;
+      }
+      memcpy(value, variable, len);
+      value[len] = '\0';
+      if(traffic_config_stage(keys[i], value) < 0) {
+        REST.set_response_status(response, REST.status.BAD_REQUEST);
+        return;
+      }
+    }
+  }
+  traffic_config_commit();
+  if(REST.get_post_variable(request, "save", &variable)
+     && traffic_config_save() < 0) {
+    REST.set_response_status(response, REST.status.INTERNAL_SERVER_ERROR);
+    return;
+  }
+  REST.set_response_status(response, REST.status.CHANGED);
+}
+
+#endif /* TRAFFIC_RUNTIME_CONFIG */
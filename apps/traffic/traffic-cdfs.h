@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \file
+ *         Inverse-CDF tables of the traffic generator distributions.
+ *         Generated by traffic-cdfs.py, do not edit.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_CDFS_H__
+#define __TRAFFIC_CDFS_H__
+
+#include <stdint.h>
+
+#define TRAFFIC_CDF_TABLE_BITS 8
+#define TRAFFIC_CDF_TABLE_SIZE 257
+
+#define TRAFFIC_CDF_GPD_SHAPE 2
+#define TRAFFIC_CDF_GPD_GENERATION_MAX 255
+#define TRAFFIC_CDF_POISSON_RATE 1
+#define TRAFFIC_CDF_POISSON_DISPERSION 0
+#define TRAFFIC_CDF_POISSON_SIZE 8
+
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_EXPONENTIAL || defined TRAFFIC_NEW_SYSTEM_GEOMETRIC
+/* -ln(1 - u), 16.16 fixed point */
+static const uint32_t traffic_cdf_exponential[257] = {
+  0, 257, 514, 773, 1032, 1293,
+  1554, 1817, 2081, 2345, 2611, 2878,
+  3146, 3415, 3686, 3957, 4230, 4503,
+  4778, 5054, 5331, 5609, 5889, 6169,
+  6451, 6734, 7019, 7304, 7591, 7879,
+  8169, 8459, 8751, 9044, 9339, 9635,
+  9932, 10231, 10530, 10832, 11135, 11439,
+  11744, 12051, 12360, 12669, 12981, 13294,
+  13608, 13924, 14241, 14560, 14880, 15202,
+  15526, 15851, 16178, 16507, 16837, 17169,
+  17502, 17837, 18174, 18513, 18854, 19196,
+  19540, 19886, 20233, 20583, 20934, 21288,
+  21643, 22000, 22359, 22720, 23083, 23448,
+  23815, 24185, 24556, 24929, 25305, 25683,
+  26063, 26445, 26829, 27216, 27605, 27996,
+  28390, 28786, 29184, 29585, 29988, 30394,
+  30802, 31213, 31627, 32043, 32461, 32883,
+  33307, 33734, 34164, 34596, 35032, 35470,
+  35911, 36356, 36803, 37254, 37707, 38164,
+  38624, 39087, 39553, 40023, 40496, 40973,
+  41453, 41937, 42424, 42915, 43409, 43908,
+  44410, 44916, 45426, 45940, 46458, 46980,
+  47507, 48037, 48572, 49112, 49656, 50204,
+  50757, 51315, 51877, 52445, 53017, 53595,
+  54177, 54765, 55358, 55957, 56561, 57170,
+  57786, 58407, 59034, 59667, 60307, 60952,
+  61604, 62263, 62928, 63600, 64280, 64966,
+  65659, 66360, 67069, 67785, 68509, 69241,
+  69982, 70731, 71489, 72255, 73031, 73816,
+  74610, 75414, 76228, 77053, 77887, 78733,
+  79590, 80458, 81338, 82229, 83133, 84050,
+  84979, 85922, 86879, 87850, 88836, 89836,
+  90852, 91884, 92933, 93999, 95082, 96183,
+  97304, 98443, 99603, 100784, 101987, 103212,
+  104460, 105733, 107030, 108354, 109706, 111085,
+  112495, 113935, 115408, 116915, 118457, 120036,
+  121654, 123314, 125016, 126764, 128559, 130405,
+  132305, 134262, 136278, 138359, 140508, 142730,
+  145029, 147413, 149886, 152457, 155132, 157921,
+  160834, 163883, 167080, 170442, 173985, 177731,
+  181704, 185934, 190455, 195312, 200558, 206260,
+  212507, 219411, 227130, 235882, 245984, 257933,
+  272557, 291410, 317983, 363409, 726817
+};
+#endif
+
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_NORMAL
+/* Standard normal quantile, 16.16 fixed point */
+static const int32_t traffic_cdf_normal[257] = {
+  -273257, -174330, -158437, -148519, -141156, -135235,
+  -130248, -125918, -122076, -118613, -115453, -112540,
+  -109834, -107304, -104924, -102675, -100540, -98507,
+  -96565, -94704, -92917, -91196, -89536, -87931,
+  -86377, -84871, -83408, -81985, -80600, -79250,
+  -77933, -76647, -75389, -74159, -72954, -71774,
+  -70616, -69480, -68364, -67268, -66191, -65131,
+  -64087, -63060, -62048, -61051, -60067, -59097,
+  -58140, -57195, -56262, -55340, -54428, -53528,
+  -52637, -51756, -50884, -50021, -49166, -48320,
+  -47482, -46651, -45828, -45012, -44203, -43401,
+  -42605, -41816, -41032, -40254, -39482, -38715,
+  -37954, -37198, -36446, -35700, -34958, -34220,
+  -33487, -32758, -32032, -31311, -30594, -29880,
+  -29170, -28463, -27759, -27059, -26362, -25668,
+  -24976, -24287, -23601, -22918, -22237, -21559,
+  -20882, -20208, -19536, -18867, -18199, -17533,
+  -16869, -16206, -15545, -14886, -14228, -13572,
+  -12917, -12263, -11611, -10960, -10310, -9660,
+  -9012, -8365, -7718, -7072, -6427, -5783,
+  -5139, -4495, -3852, -3210, -2567, -1925,
+  -1283, -642, 0, 642, 1283, 1925,
+  2567, 3210, 3852, 4495, 5139, 5783,
+  6427, 7072, 7718, 8365, 9012, 9660,
+  10310, 10960, 11611, 12263, 12917, 13572,
+  14228, 14886, 15545, 16206, 16869, 17533,
+  18199, 18867, 19536, 20208, 20882, 21559,
+  22237, 22918, 23601, 24287, 24976, 25668,
+  26362, 27059, 27759, 28463, 29170, 29880,
+  30594, 31311, 32032, 32758, 33487, 34220,
+  34958, 35700, 36446, 37198, 37954, 38715,
+  39482, 40254, 41032, 41816, 42605, 43401,
+  44203, 45012, 45828, 46651, 47482, 48320,
+  49166, 50021, 50884, 51756, 52637, 53528,
+  54428, 55340, 56262, 57195, 58140, 59097,
+  60067, 61051, 62048, 63060, 64087, 65131,
+  66191, 67268, 68364, 69480, 70616, 71774,
+  72954, 74159, 75389, 76647, 77933, 79250,
+  80600, 81985, 83408, 84871, 86377, 87931,
+  89536, 91196, 92917, 94704, 96565, 98507,
+  100540, 102675, 104924, 107304, 109834, 112540,
+  115453, 118613, 122076, 125918, 130248, 135235,
+  141156, 148519, 158437, 174330, 273257
+};
+#endif
+
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO
+/* ((1 - u)^-shape - 1) / shape, 16.16 fixed point */
+static const uint32_t traffic_cdf_gpd[257] = {
+  0, 256, 516, 779, 1044, 1313,
+  1585, 1861, 2139, 2421, 2707, 2996,
+  3288, 3585, 3884, 4188, 4495, 4806,
+  5121, 5441, 5764, 6091, 6422, 6758,
+  7098, 7442, 7791, 8145, 8503, 8866,
+  9233, 9606, 9983, 10366, 10753, 11146,
+  11545, 11948, 12358, 12773, 13193, 13620,
+  14052, 14491, 14936, 15387, 15844, 16308,
+  16779, 17257, 17741, 18233, 18731, 19237,
+  19751, 20272, 20801, 21338, 21884, 22437,
+  22999, 23569, 24149, 24737, 25334, 25941,
+  26557, 27183, 27819, 28466, 29122, 29790,
+  30468, 31157, 31857, 32569, 33293, 34029,
+  34778, 35539, 36313, 37100, 37901, 38715,
+  39544, 40387, 41245, 42119, 43008, 43912,
+  44833, 45771, 46726, 47698, 48688, 49697,
+  50725, 51772, 52838, 53925, 55033, 56162,
+  57313, 58487, 59684, 60904, 62149, 63419,
+  64714, 66036, 67384, 68761, 70166, 71601,
+  73065, 74561, 76089, 77649, 79244, 80873,
+  82538, 84240, 85980, 87758, 89578, 91438,
+  93342, 95289, 97282, 99322, 101410, 103548,
+  105738, 107981, 110278, 112633, 115046, 117520,
+  120056, 122657, 125325, 128062, 130871, 133755,
+  136715, 139754, 142877, 146085, 149381, 152770,
+  156254, 159837, 163522, 167315, 171219, 175238,
+  179377, 183641, 188034, 192563, 197233, 202049,
+  207018, 212146, 217441, 222910, 228559, 234398,
+  240435, 246679, 253140, 259827, 266751, 273924,
+  281358, 289066, 297061, 305357, 313970, 322917,
+  332215, 341882, 351938, 362405, 373304, 384661,
+  396501, 408852, 421744, 435209, 449281, 463997,
+  479398, 495526, 512429, 530155, 548761, 568304,
+  588849, 610466, 633230, 657225, 682540, 709274,
+  737536, 767443, 799127, 832730, 868411, 906345,
+  946726, 989768, 1035711, 1084821, 1137396, 1193771,
+  1254320, 1319466, 1389686, 1465521, 1547587, 1636584,
+  1733316, 1838706, 1953819, 2079890, 2218353, 2370888,
+  2539469, 2726428, 2934536, 3167108, 3428134, 3722452,
+  4055975, 4435988, 4871550, 5374039, 5957906, 6641719,
+  7449663, 8413707, 9576813, 10997812, 12758987, 14978264,
+  17829471, 21577449, 26641849, 33719917, 44039989, 59932691,
+  86272241, 134712856, 239201567, 536838144, 2114285608
+};
+#endif
+
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_POISSON \
+  || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON
+/* P(X <= k) * 65536, saturated */
+static const uint16_t traffic_cdf_poisson[8] = {
+  24109, 48218, 60273, 64291, 65296, 65497, 65530, 65535
+};
+/* Smallest k with P(X <= k) * 65536 > i * 256 */
+static const uint8_t traffic_cdf_poisson_guide[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3,
+  3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4
+};
+#endif
+
+#endif /* __TRAFFIC_CDFS_H__ */
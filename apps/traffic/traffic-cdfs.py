@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016, Georgios Exarchakos
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#
+# Generates traffic-cdfs.h, the inverse-CDF tables used by get_interval().
+#
+# Continuous distributions are tabulated as 257 quantiles in 16.16 fixed
+# point, at u = i/256 for i < 256 and at the largest 16-bit draw for the
+# last entry, so that the traffic app can sample them with one random draw
+# and a linear interpolation. Exponential and normal tables are standard
+# (mean 1, resp. mean 0 and deviation 1) and are scaled at run time. The
+# generalized Pareto and (generalized) Poisson tables depend on their shape
+# and rate, so the header must be regenerated when these change:
+#
+#   ./traffic-cdfs.py --gpd-shape 2 --gpd-generation-max 255 \
+#                     --poisson-rate 1 --poisson-dispersion 0 > traffic-cdfs.h
+
+import argparse
+import math
+import statistics
+
+TABLE_BITS = 8
+TABLE_SIZE = (1 << TABLE_BITS) + 1
+U_MAX = 65535 / 65536
+Q = 1 << 16
+
+
+def points():
+    return [i / (1 << TABLE_BITS) for i in range(TABLE_SIZE - 1)] + [U_MAX]
+
+
+def exponential(u):
+    return -math.log(1 - u)
+
+
+def normal(u):
+    u = min(max(u, 1 / 65536), U_MAX)
+    return statistics.NormalDist().inv_cdf(u)
+
+
+def gpd(u, shape, generation_max):
+    # Bound the tail: u never exceeds 1 - 1/generation_max
+    u = u * (1 - 1 / generation_max)
+    if shape == 0:
+        return exponential(u)
+    return ((1 - u) ** -shape - 1) / shape
+
+
+def generalized_poisson_pmf(k, rate, dispersion):
+    # Consul's generalized Poisson; dispersion 0 is the Poisson distribution
+    mu = rate + k * dispersion
+    if mu <= 0:
+        return 0.0
+    return math.exp(math.log(rate) + (k - 1) * math.log(mu) - mu - math.lgamma(k + 1))
+
+
+def fixed(v):
+    return int(round(v * Q))
+
+
+def c_array(ctype, name, values, per_line=6):
+    out = ['static const %s %s[%d] = {' % (ctype, name, len(values))]
+    for i in range(0, len(values), per_line):
+        out.append('  ' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    out[-1] = out[-1].rstrip(',')
+    out.append('};')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--gpd-shape', type=int, default=2)
+    parser.add_argument('--gpd-generation-max', type=int, default=255)
+    parser.add_argument('--poisson-rate', type=int, default=1)
+    parser.add_argument('--poisson-dispersion', type=int, default=0,
+                        help='generalized Poisson dispersion, in percent')
+    args = parser.parse_args()
+
+    u = points()
+    exp_table = [fixed(exponential(x)) for x in u]
+    normal_table = [fixed(normal(x)) for x in u]
+    gpd_table = [fixed(gpd(x, args.gpd_shape, args.gpd_generation_max)) for x in u]
+
+    # Poisson: cumulative probabilities in 16 bits plus a guide table that
+    # points each 8-bit bucket of the draw to its first candidate value
+    cdf = []
+    acc = 0.0
+    k = 0
+    while True:
+        acc += generalized_poisson_pmf(k, args.poisson_rate, args.poisson_dispersion / 100)
+        cdf.append(min(65535, int(acc * 65536)))
+        if cdf[-1] >= 65535 or k >= 254:
+            cdf[-1] = 65535
+            break
+        k += 1
+    guide = []
+    for i in range(1 << TABLE_BITS):
+        threshold = i << TABLE_BITS
+        guide.append(next(j for j, c in enumerate(cdf) if c > threshold))
+
+    print('''/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \\file
+ *         Inverse-CDF tables of the traffic generator distributions.
+ *         Generated by traffic-cdfs.py, do not edit.
+ *
+ * \\author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_CDFS_H__
+#define __TRAFFIC_CDFS_H__
+
+#include <stdint.h>
+
+#define TRAFFIC_CDF_TABLE_BITS %d
+#define TRAFFIC_CDF_TABLE_SIZE %d
+
+#define TRAFFIC_CDF_GPD_SHAPE %d
+#define TRAFFIC_CDF_GPD_GENERATION_MAX %d
+#define TRAFFIC_CDF_POISSON_RATE %d
+#define TRAFFIC_CDF_POISSON_DISPERSION %d
+#define TRAFFIC_CDF_POISSON_SIZE %d
+''' % (TABLE_BITS, TABLE_SIZE, args.gpd_shape, args.gpd_generation_max,
+       args.poisson_rate, args.poisson_dispersion, len(cdf)))
+    print('#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_EXPONENTIAL || defined TRAFFIC_NEW_SYSTEM_GEOMETRIC')
+    print('/* -ln(1 - u), 16.16 fixed point */')
+    print(c_array('uint32_t', 'traffic_cdf_exponential', exp_table))
+    print('#endif\n')
+    print('#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_NORMAL')
+    print('/* Standard normal quantile, 16.16 fixed point */')
+    print(c_array('int32_t', 'traffic_cdf_normal', normal_table))
+    print('#endif\n')
+    print('#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO')
+    print('/* ((1 - u)^-shape - 1) / shape, 16.16 fixed point */')
+    print(c_array('uint32_t', 'traffic_cdf_gpd', gpd_table))
+    print('#endif\n')
+    print('#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_POISSON \\\n  || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON')
+    print('/* P(X <= k) * 65536, saturated */')
+    print(c_array('uint16_t', 'traffic_cdf_poisson', cdf, 8))
+    print('/* Smallest k with P(X <= k) * 65536 > i * 256 */')
+    print(c_array('uint8_t', 'traffic_cdf_poisson_guide', guide, 16))
+    print('#endif\n')
+    print('#endif /* __TRAFFIC_CDFS_H__ */')
+
+
+if __name__ == '__main__':
+    main()
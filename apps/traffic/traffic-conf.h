@@ -33,12 +33,30 @@
 #define TRAFFIC_TRANSMIT_PAYLOAD traffic_transmit_hello
 #endif
 
+/* Let the distribution, destinations and payload size of the default flow
+ * be changed on a live node (traffic-config.h). The TRAFFIC_NEW_SYSTEM_*
+ * macros below then only give its initial distribution, and the tables of
+ * all distributions are compiled in */
+#ifndef TRAFFIC_RUNTIME_CONFIG
+#define TRAFFIC_RUNTIME_CONFIG 0
+#endif
+
+/* Send time carried in the header. One-way latencies are only meaningful
+ * when senders and receivers share this clock, e.g. in Cooja or with the
+ * TSCH ASN */
+#ifndef TRAFFIC_TIMESTAMP
+#define TRAFFIC_TIMESTAMP() ((uint32_t)clock_time())
+#endif
+
 //#undef TRAFFIC_CDF_SHIFT_FACTOR
 //#define TRAFFIC_CDF_SHIFT_FACTOR (TRAFFIC_CDF_DELTA_PULSE - 21845) // TRAFFIC_CDF_SHIFT_FACTOR = TRAFFIC_DELTA_CDF_PULSE - 21845
 
 //temp
 #define TRAFFIC_DESTINATIONS sinks
 #define TRAFFIC_DESTINATIONS_COUNT 1
+/* With TRAFFIC_RUNTIME_CONFIG, only the defaults of traffic-config.c read
+ * the destinations */
+#if !TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_CONFIG_DEFAULTS
 static const char *sinks[TRAFFIC_DESTINATIONS_COUNT] = {
 #ifdef TRAFFIC_ROUTING_RPL
   "c30c:0:0:1",
@@ -145,12 +163,14 @@ static const char *sinks[TRAFFIC_DESTINATIONS_COUNT] = {
   50
 #endif
 };
+#endif
 #define TRAFFIC_TRANSMIT_PAYLOAD traffic_transmit_hello
 
 
-// Define TRAFFIC_NEW_SYSTEM_PRECISE in order to use less efficient, more exact probability calculations.
-#define TRAFFIC_NEW_SYSTEM_PRECISE
-
+// Intervals are the sum of the enabled distributions below, in seconds. Each
+// one is sampled from its inverse-CDF table in traffic-cdfs.h. The tables of
+// the generalized Pareto and Poisson distributions depend on their shape and
+// rate: regenerate traffic-cdfs.h with traffic-cdfs.py when changing these.
 
 #define TRAFFIC_NEW_SYSTEM_DELTA
 #define TRAFFIC_NEW_SYSTEM_DELTA_MEAN 1000
@@ -158,19 +178,26 @@ static const char *sinks[TRAFFIC_DESTINATIONS_COUNT] = {
 //#define TRAFFIC_NEW_SYSTEM_UNIFORM
 #define TRAFFIC_NEW_SYSTEM_UNIFORM_MAX 20
 
+//#define TRAFFIC_NEW_SYSTEM_EXPONENTIAL
+#define TRAFFIC_NEW_SYSTEM_EXPONENTIAL_MEAN 20
+
 //#define TRAFFIC_NEW_SYSTEM_GEOMETRIC
 #define TRAFFIC_NEW_SYSTEM_GEOMETRIC_PROBABILITY 63000 // Probability that no package is transmitted in the next time stap, as a fraction of 65535
 #define TRAFFIC_NEW_SYSTEM_GEOMETRIC_DOWNSCALE 1 // Time step is usually 1 second (up to 2 minutes), modify this to downscale that. 
 
+//#define TRAFFIC_NEW_SYSTEM_NORMAL
+#define TRAFFIC_NEW_SYSTEM_NORMAL_MEAN 20
+#define TRAFFIC_NEW_SYSTEM_NORMAL_STANDARD_DEVIATION 5 // Negative samples are truncated to 0
+
 //#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO
-#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN 20
-#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION 10
+#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN 20 // Location
+#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION 10 // Scale
 #define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE 2
-#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX 255 // Must be set low enough (such that GENERATION_MAX ^ SHAPE < 65535). A lower value means less precise calculations.
+#define TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX 255 // Bounds the tail: the largest sample is that of u = 1 - 1/GENERATION_MAX
 
 //#define TRAFFIC_NEW_SYSTEM_POISSON
-#define TRAFFIC_NEW_SYSTEM_POISSON_E_NUMERATOR 693
-#define TRAFFIC_NEW_SYSTEM_POISSON_E_DENOMINATOR 255
-#define TRAFFIC_NEW_SYSTEM_POISSON_RATE 1 // Must be a very small (single-digit) positive integer for accurate resultsz
+//#define TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON
+#define TRAFFIC_NEW_SYSTEM_POISSON_RATE 1 // Mean number of seconds for the Poisson distribution
+#define TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON_DISPERSION 0 // In percent, 0 for the Poisson distribution
 
 #endif
\ No newline at end of file
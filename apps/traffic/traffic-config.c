@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *       Runtime configuration of the traffic generator
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ *
+ */
+
+#include "contiki.h"
+#include "traffic-config.h"
+
+#if TRAFFIC_RUNTIME_CONFIG
+
+/* The compile-time destinations of traffic-conf.h */
+#define TRAFFIC_CONFIG_DEFAULTS
+#include "traffic-conf.h"
+#include "traffic.h"
+#if CONTIKI_CONF_SETTINGS_MANAGER
+#include "lib/settings.h"
+#endif
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Application settings keys are lower case, see lib/settings.h */
+#define TRAFFIC_SETTINGS_KEY_PARAMETERS   TCC('t', 'g')
+#define TRAFFIC_SETTINGS_KEY_DESTINATIONS TCC('t', 'd')
+#define PARAMETERS_LEN 16
+
+struct traffic_config traffic_config;
+
+/* Changes are parsed into a copy, which replaces traffic_config only once
+ * all of them are valid */
+static struct traffic_config staged;
+static uint8_t initialized;
+
+static const char *distribution_names[TRAFFIC_DISTRIBUTION_COUNT] = {
+  "delta", "uniform", "exponential", "geometric", "normal", "pareto", "poisson"
+};
+
+/*---------------------------------------------------------------------------*/
+const char *
+traffic_config_distribution_name(uint8_t distribution)
+{
+  if(distribution >= TRAFFIC_DISTRIBUTION_COUNT) {
+    return NULL;
+  }
+  return distribution_names[distribution];
+}
+/*---------------------------------------------------------------------------*/
+/* The first distribution enabled by the TRAFFIC_NEW_SYSTEM_* macros */
+static void
+defaults(void)
+{
+#if defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
+  int i;
+#endif
+
+  memset(&traffic_config, 0, sizeof(traffic_config));
+  traffic_config.port = TRAFFIC_PORT;
+  traffic_config.payload_size = UIP_APPDATA_SIZE;
+#if defined TRAFFIC_NEW_SYSTEM_DELTA
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_DELTA;
+  traffic_config.interval = (uint32_t)TRAFFIC_NEW_SYSTEM_DELTA_MEAN * 1000;
+#elif defined TRAFFIC_NEW_SYSTEM_UNIFORM
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_UNIFORM;
+  traffic_config.interval = (uint32_t)TRAFFIC_NEW_SYSTEM_UNIFORM_MAX * 1000;
+#elif defined TRAFFIC_NEW_SYSTEM_EXPONENTIAL
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_EXPONENTIAL;
+  traffic_config.interval = (uint32_t)TRAFFIC_NEW_SYSTEM_EXPONENTIAL_MEAN * 1000;
+#elif defined TRAFFIC_NEW_SYSTEM_GEOMETRIC
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_GEOMETRIC;
+  traffic_config.interval = 1000 / TRAFFIC_NEW_SYSTEM_GEOMETRIC_DOWNSCALE;
+  traffic_config.probability = TRAFFIC_NEW_SYSTEM_GEOMETRIC_PROBABILITY;
+#elif defined TRAFFIC_NEW_SYSTEM_NORMAL
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_NORMAL;
+  traffic_config.interval = (uint32_t)TRAFFIC_NEW_SYSTEM_NORMAL_MEAN * 1000;
+  traffic_config.deviation = (uint32_t)TRAFFIC_NEW_SYSTEM_NORMAL_STANDARD_DEVIATION * 1000;
+#elif defined TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_PARETO;
+  traffic_config.interval = (uint32_t)TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN * 1000;
+  traffic_config.deviation = (uint32_t)TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION * 1000;
+#elif defined TRAFFIC_NEW_SYSTEM_POISSON || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_POISSON;
+  traffic_config.interval = 1000;
+#else
+  traffic_config.distribution = TRAFFIC_DISTRIBUTION_DELTA;
+  traffic_config.interval = 1000;
+#endif
+
+#if defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
+  for(i = 0; i < TRAFFIC_DESTINATIONS_COUNT && i < TRAFFIC_CONFIG_MAX_DESTINATIONS; i++) {
+#ifdef TRAFFIC_ROUTING_UAODV
+    /* uAODV destinations are host numbers, not strings */
+    snprintf(traffic_config.destinations[i], TRAFFIC_CONFIG_ADDRESS_LEN, "%u",
+             (unsigned)(uintptr_t)TRAFFIC_DESTINATIONS[i]);
+#else
+    strncpy(traffic_config.destinations[i], TRAFFIC_DESTINATIONS[i],
+            TRAFFIC_CONFIG_ADDRESS_LEN - 1);
+#endif
+  }
+  traffic_config.destinations_count = i;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Whether traffic.c can resolve a destination. Under RPL, it is an IPv6
+ * address, or its last groups, which are completed with the prefix of our
+ * own global address. Under uAODV, it is the host number x of 172.16.x.0. */
+static int
+valid_destination(const char *s)
+{
+#ifdef TRAFFIC_ROUTING_UAODV
+  char *end;
+  unsigned long n = strtoul(s, &end, 10);
+  return end != s && *end == '\0' && n > 0 && n < 255;
+#else
+  int groups = 0, digits, compressed = 0;
+
+  while(1) {
+    digits = 0;
+    while(isxdigit((unsigned char)*s)) {
+      if(++digits > 4) {
+        return 0;
+      }
+      s++;
+    }
+    if(digits > 0) {
+      groups++;
+    }
+    if(*s == '\0') {
+      break;
+    }
+    if(*s != ':') {
+      return 0;
+    }
+    if(s[1] == ':') {
+      /* At most one "::", which may end the string */
+      if(compressed++) {
+        return 0;
+      }
+      s += 2;
+      if(*s == '\0') {
+        break;
+      }
+    } else if(digits == 0 || *++s == '\0') {
+      /* An empty group, or a trailing ':' */
+      return 0;
+    }
+  }
+  /* "::" stands for at least one group of zeros */
+  return groups > 0 && groups <= (compressed ? 7 : 8);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+#if CONTIKI_CONF_SETTINGS_MANAGER
+static void
+load(void)
+{
+  uint8_t buf[PARAMETERS_LEN];
+  settings_length_t len = sizeof(buf);
+  uint8_t i;
+
+  if(settings_get(TRAFFIC_SETTINGS_KEY_PARAMETERS, 0, buf, &len) == SETTINGS_STATUS_OK
+     && len == PARAMETERS_LEN && buf[14] < TRAFFIC_DISTRIBUTION_COUNT
+     && (buf[0] | buf[1] | buf[2] | buf[3]) != 0) {
+    traffic_config.interval = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8)
+      | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+    traffic_config.deviation = (uint32_t)buf[4] | ((uint32_t)buf[5] << 8)
+      | ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+    traffic_config.probability = buf[8] | (buf[9] << 8);
+    traffic_config.port = buf[10] | (buf[11] << 8);
+    traffic_config.payload_size = buf[12] | (buf[13] << 8);
+    traffic_config.distribution = buf[14];
+    for(i = 0; i < buf[15] && i < TRAFFIC_CONFIG_MAX_DESTINATIONS; i++) {
+      if(settings_get_cstr(TRAFFIC_SETTINGS_KEY_DESTINATIONS, i,
+                           traffic_config.destinations[i],
+                           TRAFFIC_CONFIG_ADDRESS_LEN) == NULL
+         || !valid_destination(traffic_config.destinations[i])) {
+        break;
+      }
+    }
+    traffic_config.destinations_count = i;
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+void
+traffic_config_init(void)
+{
+  /* Once only, so that traffic_process does not undo earlier changes */
+  if(initialized) {
+    return;
+  }
+  initialized = 1;
+  defaults();
+#if CONTIKI_CONF_SETTINGS_MANAGER
+  load();
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static int
+parse_number(const char *value, uint32_t max, uint32_t *number)
+{
+  char *end;
+  unsigned long n = strtoul(value, &end, 10);
+  if(end == value || *end != '\0' || n > max) {
+    return -1;
+  }
+  *number = n;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+parse_destinations(struct traffic_config *config, const char *value)
+{
+  char destinations[TRAFFIC_CONFIG_MAX_DESTINATIONS][TRAFFIC_CONFIG_ADDRESS_LEN];
+  uint8_t count = 0;
+  int len;
+
+  while(*value != '\0') {
+    len = strcspn(value, ", ");
+    if(len > 0) {
+      if(count == TRAFFIC_CONFIG_MAX_DESTINATIONS
+         || len >= TRAFFIC_CONFIG_ADDRESS_LEN) {
+        return -1;
+      }
+      memcpy(destinations[count], value, len);
+      destinations[count][len] = '\0';
+      if(!valid_destination(destinations[count])) {
+        return -1;
+      }
+      count++;
+      value += len;
+    } else {
+      value++;
+    }
+  }
+  memcpy(config->destinations, destinations, count * TRAFFIC_CONFIG_ADDRESS_LEN);
+  config->destinations_count = count;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_config_begin(void)
+{
+  traffic_config_init();
+  memcpy(&staged, &traffic_config, sizeof(staged));
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_config_stage(const char *key, const char *value)
+{
+  uint32_t n;
+  uint8_t i;
+
+  if(strcmp(key, "dist") == 0) {
+    for(i = 0; i < TRAFFIC_DISTRIBUTION_COUNT; i++) {
+      if(strcmp(value, distribution_names[i]) == 0) {
+        break;
+      }
+    }
+    if(i == TRAFFIC_DISTRIBUTION_COUNT) {
+      return -1;
+    }
+    staged.distribution = i;
+  } else if(strcmp(key, "dest") == 0) {
+    if(parse_destinations(&staged, value) < 0) {
+      return -1;
+    }
+  } else {
+    if(parse_number(value, 0xffffffff, &n) < 0) {
+      return -1;
+    }
+    if(strcmp(key, "interval") == 0 && n > 0) {
+      staged.interval = n;
+    } else if(strcmp(key, "deviation") == 0) {
+      staged.deviation = n;
+    } else if(strcmp(key, "probability") == 0 && n <= 0xffff) {
+      staged.probability = n;
+    } else if(strcmp(key, "port") == 0 && n > 0 && n <= 0xffff) {
+      staged.port = n;
+    } else if(strcmp(key, "size") == 0 && n <= 0xffff) {
+      staged.payload_size = n;
+    } else {
+      return -1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_config_commit(void)
+{
+  memcpy(&traffic_config, &staged, sizeof(traffic_config));
+  traffic_reconfigure();
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_config_set(const char *key, const char *value)
+{
+  traffic_config_begin();
+  if(traffic_config_stage(key, value) < 0) {
+    return -1;
+  }
+  traffic_config_commit();
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_config_save(void)
+{
+#if CONTIKI_CONF_SETTINGS_MANAGER
+  uint8_t buf[PARAMETERS_LEN];
+  uint8_t i;
+
+  buf[0] = traffic_config.interval & 0xff;
+  buf[1] = (traffic_config.interval >> 8) & 0xff;
+  buf[2] = (traffic_config.interval >> 16) & 0xff;
+  buf[3] = traffic_config.interval >> 24;
+  buf[4] = traffic_config.deviation & 0xff;
+  buf[5] = (traffic_config.deviation >> 8) & 0xff;
+  buf[6] = (traffic_config.deviation >> 16) & 0xff;
+  buf[7] = traffic_config.deviation >> 24;
+  buf[8] = traffic_config.probability & 0xff;
+  buf[9] = traffic_config.probability >> 8;
+  buf[10] = traffic_config.port & 0xff;
+  buf[11] = traffic_config.port >> 8;
+  buf[12] = traffic_config.payload_size & 0xff;
+  buf[13] = traffic_config.payload_size >> 8;
+  buf[14] = traffic_config.distribution;
+  buf[15] = traffic_config.destinations_count;
+  if(settings_set(TRAFFIC_SETTINGS_KEY_PARAMETERS, buf, sizeof(buf)) != SETTINGS_STATUS_OK) {
+    return -1;
+  }
+
+  /* Destinations are stored as one value per index of their key */
+  while(settings_delete(TRAFFIC_SETTINGS_KEY_DESTINATIONS, 0) == SETTINGS_STATUS_OK);
+  for(i = 0; i < traffic_config.destinations_count; i++) {
+    if(settings_add_cstr(TRAFFIC_SETTINGS_KEY_DESTINATIONS,
+                         traffic_config.destinations[i]) != SETTINGS_STATUS_OK) {
+      return -1;
+    }
+  }
+  return 0;
+#else
+  return -1;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_config_format(char *buf, int size)
+{
+  return snprintf(buf, size,
+                  "dist %s interval %lu deviation %lu probability %u port %u size %u",
+                  distribution_names[traffic_config.distribution],
+                  (unsigned long)traffic_config.interval,
+                  (unsigned long)traffic_config.deviation,
+                  traffic_config.probability, traffic_config.port,
+                  traffic_config.payload_size);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TRAFFIC_RUNTIME_CONFIG */
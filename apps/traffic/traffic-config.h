@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \file
+ *         Runtime configuration of the default flow of the traffic
+ *         generator: distribution and its parameters, destination port,
+ *         payload size and destinations. Set through the traffic-config
+ *         shell command or the CoAP resource in res-traffic.c, and
+ *         persisted with the settings manager when it is enabled.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_CONFIG_H__
+#define __TRAFFIC_CONFIG_H__
+
+#include "contiki.h"
+
+#ifndef TRAFFIC_CONFIG_MAX_DESTINATIONS
+#define TRAFFIC_CONFIG_MAX_DESTINATIONS 8
+#endif
+
+/* Longest destination string, including its terminating zero */
+#ifndef TRAFFIC_CONFIG_ADDRESS_LEN
+#define TRAFFIC_CONFIG_ADDRESS_LEN 40
+#endif
+
+/* Distributions. Their parameters are, in milliseconds:
+ * delta: interval
+ * uniform: interval is the largest value
+ * exponential: interval is the mean
+ * geometric: interval is the time step, probability that of no packet in
+ *            a step, as a fraction of 65535
+ * normal: interval is the mean, deviation the standard deviation
+ * pareto: interval is the location, deviation the scale; the shape is
+ *         that of traffic-cdfs.h
+ * poisson: interval is the duration of one count; the rate and dispersion
+ *          are those of traffic-cdfs.h */
+#define TRAFFIC_DISTRIBUTION_DELTA 0
+#define TRAFFIC_DISTRIBUTION_UNIFORM 1
+#define TRAFFIC_DISTRIBUTION_EXPONENTIAL 2
+#define TRAFFIC_DISTRIBUTION_GEOMETRIC 3
+#define TRAFFIC_DISTRIBUTION_NORMAL 4
+#define TRAFFIC_DISTRIBUTION_PARETO 5
+#define TRAFFIC_DISTRIBUTION_POISSON 6
+#define TRAFFIC_DISTRIBUTION_COUNT 7
+
+struct traffic_config {
+  uint32_t interval;
+  uint32_t deviation;
+  uint16_t probability;
+  uint16_t port;                         /* Destination UDP port */
+  uint16_t payload_size;                 /* Largest payload, header included */
+  uint8_t distribution;
+  uint8_t destinations_count;
+  char destinations[TRAFFIC_CONFIG_MAX_DESTINATIONS][TRAFFIC_CONFIG_ADDRESS_LEN];
+};
+
+extern struct traffic_config traffic_config;
+
+/**
+ * \brief Load the configuration: the compile-time TRAFFIC_* values,
+ *        overridden by those saved with traffic_config_save(). Only the
+ *        first call has an effect.
+ */
+void traffic_config_init(void);
+
+/**
+ * \brief Change one parameter and apply it to the running generator
+ * \param key One of dist, interval, deviation, probability, port, size or
+ *        dest, the latter taking a list of addresses separated by commas
+ *        or spaces
+ * \param value The new value, as text. The interval must not be 0.
+ * \return 0 on success, -1 for an unknown key or an invalid value
+ */
+int traffic_config_set(const char *key, const char *value);
+
+/**
+ * \brief Start a change of several parameters at once, from the current
+ *        configuration
+ */
+void traffic_config_begin(void);
+
+/**
+ * \brief Parse one parameter of the change started by traffic_config_begin()
+ * \param key As traffic_config_set()
+ * \param value As traffic_config_set()
+ * \return 0 on success, -1 for an unknown key or an invalid value. Nothing
+ *         is applied until traffic_config_commit().
+ */
+int traffic_config_stage(const char *key, const char *value);
+
+/**
+ * \brief Apply all the parameters staged since traffic_config_begin() to
+ *        the running generator
+ */
+void traffic_config_commit(void);
+
+/**
+ * \brief Persist the configuration with the settings manager
+ * \return 0 on success, -1 if it failed or the settings manager is disabled
+ */
+int traffic_config_save(void);
+
+/**
+ * \brief Format the parameters, destinations excluded, as one line of text
+ * \return The length of the text, as snprintf()
+ */
+int traffic_config_format(char *buf, int size);
+
+/**
+ * \brief Name of a distribution, NULL if unknown
+ */
+const char *traffic_config_distribution_name(uint8_t distribution);
+
+#endif /* __TRAFFIC_CONFIG_H__ */
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016, Georgios Exarchakos
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#
+# Decodes the binary event log of the traffic app (TRAFFIC_LOG_LEVEL 2) from
+# serial or Cooja logs into CSV. The last field before the "TRAFFIC-LOG:"
+# prefix on a line (e.g. the Cooja mote id) identifies the node.
+#
+#   ./traffic-log-decode.py COOJA.testlog > events.csv
+
+import argparse
+import struct
+import sys
+
+PREFIX = 'TRAFFIC-LOG:'
+# time, seq, size, peer, type, flow; see struct traffic_log_t
+RECORD = struct.Struct('<IHHHBB')
+TYPES = {0: 'tx', 1: 'rx'}
+FLOW_UNKNOWN = 0xff
+
+
+def decode(lines, out):
+    clock_second = {}
+    out.write('source,time,type,flow,peer,seq,size\n')
+    for line in lines:
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        fields = line[:pos].split()
+        source = fields[-1] if fields else ''
+        payload = line[pos + len(PREFIX):].strip()
+        if payload.startswith('clock '):
+            clock_second[source] = int(payload.split()[1])
+            continue
+        if payload.startswith('dropped '):
+            sys.stderr.write('%s: %s events dropped\n' % (source, payload.split()[1]))
+            continue
+        try:
+            record = bytes.fromhex(payload)
+        except ValueError:
+            sys.stderr.write('malformed record: %s\n' % line.rstrip())
+            continue
+        if len(record) != RECORD.size:
+            # Typically the last line of a log cut short
+            sys.stderr.write('truncated record, %d of %d bytes: %s\n' % (
+                len(record), RECORD.size, line.rstrip()))
+            continue
+        time, seq, size, peer, kind, flow = RECORD.unpack(record)
+        seconds = time / clock_second.get(source, 1)
+        out.write('%s,%.3f,%s,%s,%04x,%u,%u\n' % (
+            source, seconds, TYPES.get(kind, kind),
+            '' if flow == FLOW_UNKNOWN else flow, peer, seq, size))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode traffic app event logs')
+    parser.add_argument('log', nargs='?', type=argparse.FileType('r'), default=sys.stdin)
+    args = parser.parse_args()
+    decode(args.log, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
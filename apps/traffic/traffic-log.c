@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *       Binary event log of the traffic generator
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ *
+ */
+
+#include "contiki.h"
+#include "lib/ringbufindex.h"
+#include "traffic-log.h"
+
+#include <stdio.h>
+
+#if TRAFFIC_LOG_LEVEL == 2
+
+#if (TRAFFIC_LOG_QUEUE_LEN & (TRAFFIC_LOG_QUEUE_LEN - 1)) != 0
+#error TRAFFIC_LOG_QUEUE_LEN must be power of two
+#endif
+
+PROCESS(traffic_log_process, "Traffic log process");
+
+static struct ringbufindex log_ringbuf;
+static struct traffic_log_t log_array[TRAFFIC_LOG_QUEUE_LEN];
+static uint16_t log_dropped = 0;
+
+/*---------------------------------------------------------------------------*/
+static void
+print_hex(uint32_t value, uint8_t bytes)
+{
+  /* Little endian, two hex digits per byte */
+  while(bytes--) {
+    printf("%02x", (unsigned)(value & 0xff));
+    value >>= 8;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Print and remove all pending events */
+void
+traffic_log_process_pending(void)
+{
+  static uint16_t last_log_dropped = 0;
+  int16_t log_index;
+
+  if(log_dropped != last_log_dropped) {
+    printf(TRAFFIC_LOG_PREFIX " dropped %u\n", log_dropped);
+    last_log_dropped = log_dropped;
+  }
+  while((log_index = ringbufindex_peek_get(&log_ringbuf)) != -1) {
+    struct traffic_log_t *log = &log_array[log_index];
+    printf(TRAFFIC_LOG_PREFIX " ");
+    print_hex(log->time, 4);
+    print_hex(log->seq, 2);
+    print_hex(log->size, 2);
+    print_hex(log->peer, 2);
+    print_hex(log->type, 1);
+    print_hex(log->flow, 1);
+    printf("\n");
+    ringbufindex_get(&log_ringbuf);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_log_add(uint8_t type, uint8_t flow, const uip_ipaddr_t *peer,
+                uint16_t seq, uint16_t size)
+{
+  int log_index = ringbufindex_peek_put(&log_ringbuf);
+  if(log_index != -1) {
+    struct traffic_log_t *log = &log_array[log_index];
+    log->time = clock_time();
+    log->seq = seq;
+    log->size = size;
+    log->peer = peer != NULL ? (peer->u8[sizeof(uip_ipaddr_t) - 2] << 8) | peer->u8[sizeof(uip_ipaddr_t) - 1] : 0;
+    log->type = type;
+    log->flow = flow;
+    ringbufindex_put(&log_ringbuf);
+    /* Print in batches, once half of the buffer is in use */
+    if(ringbufindex_elements(&log_ringbuf) >= TRAFFIC_LOG_QUEUE_LEN / 2) {
+      process_poll(&traffic_log_process);
+    }
+  } else {
+    log_dropped++;
+    process_poll(&traffic_log_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_log_init(void)
+{
+  ringbufindex_init(&log_ringbuf, TRAFFIC_LOG_QUEUE_LEN);
+  printf(TRAFFIC_LOG_PREFIX " clock %lu\n", (unsigned long)CLOCK_SECOND);
+  process_start(&traffic_log_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(traffic_log_process, ev, data)
+{
+  static struct etimer flush_timer;
+
+  PROCESS_BEGIN();
+  etimer_set(&flush_timer, TRAFFIC_LOG_FLUSH_INTERVAL);
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL || etimer_expired(&flush_timer));
+    traffic_log_process_pending();
+    if(etimer_expired(&flush_timer)) {
+      etimer_reset(&flush_timer);
+    }
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* TRAFFIC_LOG_LEVEL */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \file
+ *         Binary event log of the traffic generator. Per-packet events are
+ *         stored as fixed-size records in a ring buffer and printed later,
+ *         hex-encoded and in batches, by a low priority process. Decode
+ *         them with traffic-log-decode.py.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_LOG_H__
+#define __TRAFFIC_LOG_H__
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+
+/* Log levels:
+ * 0: no output
+ * 1: process state and errors only
+ * 2: as 1, plus per-packet events in the binary log (default)
+ * 3: as 1, plus per-packet events printed in full as text */
+#ifndef TRAFFIC_LOG_LEVEL
+#define TRAFFIC_LOG_LEVEL 2
+#endif
+
+/* Number of events buffered before they are printed, a power of two */
+#ifndef TRAFFIC_LOG_QUEUE_LEN
+#define TRAFFIC_LOG_QUEUE_LEN 16
+#endif
+
+/* Pending events are printed at least this often */
+#ifndef TRAFFIC_LOG_FLUSH_INTERVAL
+#define TRAFFIC_LOG_FLUSH_INTERVAL (10 * CLOCK_SECOND)
+#endif
+
+/* Line prefix of the binary log, as expected by traffic-log-decode.py */
+#define TRAFFIC_LOG_PREFIX "TRAFFIC-LOG:"
+
+/* Event types */
+#define TRAFFIC_LOG_TX 0
+#define TRAFFIC_LOG_RX 1
+
+/* Flow id of received packets that do not identify their flow */
+#define TRAFFIC_LOG_FLOW_UNKNOWN 0xff
+
+/* One per-packet event, printed as 12 little-endian bytes */
+struct traffic_log_t {
+  uint32_t time;  /* clock_time() of the event */
+  uint16_t seq;   /* Sequence number of the packet */
+  uint16_t size;  /* Payload size */
+  uint16_t peer;  /* Last two bytes of the destination or source address */
+  uint8_t type;   /* TRAFFIC_LOG_TX or TRAFFIC_LOG_RX */
+  uint8_t flow;   /* Flow id */
+};
+
+#if TRAFFIC_LOG_LEVEL == 2
+
+void traffic_log_init(void);
+void traffic_log_add(uint8_t type, uint8_t flow, const uip_ipaddr_t *peer,
+                     uint16_t seq, uint16_t size);
+void traffic_log_process_pending(void);
+
+#define TRAFFIC_LOG_ADD(type, flow, peer, seq, size) \
+  traffic_log_add((type), (flow), (peer), (seq), (size))
+
+#else /* TRAFFIC_LOG_LEVEL */
+
+#define traffic_log_init()
+#define traffic_log_process_pending()
+#define TRAFFIC_LOG_ADD(type, flow, peer, seq, size)
+
+#endif /* TRAFFIC_LOG_LEVEL */
+
+#endif /* __TRAFFIC_LOG_H__ */
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *       Receiver-side statistics of the traffic generator
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ *
+ */
+
+#include "contiki.h"
+#include "traffic-stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Like nbr-table: a fixed array of entries, found by their key */
+static struct traffic_stats stats_table[TRAFFIC_STATS_MAX_SOURCES];
+uint32_t traffic_stats_evicted = 0;
+
+/* Width of the duplicate detection window */
+#define WINDOW_SIZE 32
+
+/* Room for a summary line or a histogram of up to 16 bins */
+#define LINE_LEN 128
+
+/*---------------------------------------------------------------------------*/
+struct traffic_stats *
+traffic_stats_lookup(uint16_t origin, uint8_t flow)
+{
+  int i;
+  for(i = 0; i < TRAFFIC_STATS_MAX_SOURCES; i++) {
+    if(stats_table[i].used && stats_table[i].origin == origin
+       && stats_table[i].flow == flow) {
+      return &stats_table[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Take a free entry, or the least recently seen one if there is none */
+static struct traffic_stats *
+add(uint16_t origin, uint8_t flow, clock_time_t now)
+{
+  struct traffic_stats *s = NULL;
+  int i;
+
+  for(i = 0; i < TRAFFIC_STATS_MAX_SOURCES; i++) {
+    if(!stats_table[i].used) {
+      s = &stats_table[i];
+      break;
+    }
+    if(s == NULL
+       || (clock_time_t)(now - stats_table[i].last_arrival)
+          > (clock_time_t)(now - s->last_arrival)) {
+      s = &stats_table[i];
+    }
+  }
+  if(s->used) {
+    traffic_stats_evicted++;
+  }
+  memset(s, 0, sizeof(struct traffic_stats));
+  s->used = 1;
+  s->origin = origin;
+  s->flow = flow;
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+static void
+count(uint16_t *bins, int size, uint32_t value)
+{
+  int bin = 0;
+  while(value > 1 && bin < size - 1) {
+    value >>= 1;
+    bin++;
+  }
+  if(bins[bin] < 0xffff) {
+    bins[bin]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct traffic_stats *
+traffic_stats_arrival(uint16_t origin, uint8_t flow)
+{
+  clock_time_t now = clock_time();
+  struct traffic_stats *s = traffic_stats_lookup(origin, flow);
+
+  if(s == NULL) {
+    s = add(origin, flow, now);
+  } else {
+    s->last_interval = now - s->last_arrival;
+    count(s->arrival, TRAFFIC_STATS_ARRIVAL_BINS, s->last_interval);
+  }
+  s->last_arrival = now;
+  s->packets++;
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_stats_sequence(struct traffic_stats *s, uint16_t seq,
+                       uint32_t latency)
+{
+  int16_t ahead;
+  int32_t d;
+
+  if(s->received == 0) {
+    s->first_seq = seq;
+    s->highest_seq = (uint32_t)seq - 1;
+  }
+
+  /* Sequence numbers wrap, compare them by their signed difference. The
+     highest one is extended to 32 bits by adding up the differences. */
+  ahead = (int16_t)(seq - (uint16_t)s->highest_seq);
+  if(ahead > 0) {
+    s->seen_window = ahead >= WINDOW_SIZE ? 0 : s->seen_window << ahead;
+    s->seen_window |= 1;
+    s->highest_seq += ahead;
+  } else {
+    uint16_t depth = -ahead;
+    if(depth < WINDOW_SIZE && (s->seen_window & ((uint32_t)1 << depth))) {
+      s->duplicates++;
+      return;
+    }
+    if(depth < WINDOW_SIZE) {
+      s->seen_window |= (uint32_t)1 << depth;
+    }
+    s->reordered++;
+    if(depth > s->max_reorder_depth) {
+      s->max_reorder_depth = depth;
+    }
+  }
+  s->received++;
+
+  count(s->latency, TRAFFIC_STATS_LATENCY_BINS, latency);
+
+  /* RFC 3550 jitter: J += (|D| - J) / 16, kept scaled by 16 */
+  if(s->received > 1) {
+    d = (int32_t)(latency - s->last_transit);
+    if(d < 0) {
+      d = -d;
+    }
+    s->jitter += d - ((s->jitter + 8) >> 4);
+  }
+  s->last_transit = latency;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+traffic_stats_expected(const struct traffic_stats *s)
+{
+  if(s->received == 0) {
+    return 0;
+  }
+  return s->highest_seq - s->first_seq + 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+traffic_stats_pdr(const struct traffic_stats *s)
+{
+  uint32_t expected = traffic_stats_expected(s);
+  if(s->received >= expected) {
+    return 1000;
+  }
+  if(s->received > 0xffffffffUL / 1000) {
+    /* Keep clear of 32-bit overflows on long runs */
+    return s->received / (expected / 1000);
+  }
+  return (s->received * 1000) / expected;
+}
+/*---------------------------------------------------------------------------*/
+struct traffic_stats *
+traffic_stats_next(struct traffic_stats *s)
+{
+  s = s == NULL ? stats_table : s + 1;
+  for(; s < &stats_table[TRAFFIC_STATS_MAX_SOURCES]; s++) {
+    if(s->used) {
+      return s;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_stats_reset(void)
+{
+  memset(stats_table, 0, sizeof(stats_table));
+  traffic_stats_evicted = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_stats_format(char *buf, int size, const struct traffic_stats *s)
+{
+  return snprintf(buf, size,
+                  "%04x/%u pkts %lu rx %lu/%lu pdr %u dup %lu reord %lu depth %u jitter %lu",
+                  s->origin, s->flow, (unsigned long)s->packets,
+                  (unsigned long)s->received,
+                  (unsigned long)traffic_stats_expected(s),
+                  traffic_stats_pdr(s), (unsigned long)s->duplicates,
+                  (unsigned long)s->reordered, s->max_reorder_depth,
+                  (unsigned long)(s->jitter >> 4));
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_stats_format_histogram(char *buf, int size, const uint16_t *bins,
+                               int count)
+{
+  int i;
+  int len = 0;
+
+  if(size > 0) {
+    buf[0] = '\0';
+  }
+  for(i = 0; i < count; i++) {
+    len += snprintf(buf + MIN(len, size), size - MIN(len, size), "%s%u",
+                    i ? " " : "", bins[i]);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_stats_print(void)
+{
+  char buf[LINE_LEN];
+  struct traffic_stats *s;
+
+  for(s = traffic_stats_next(NULL); s != NULL; s = traffic_stats_next(s)) {
+    traffic_stats_format(buf, sizeof(buf), s);
+    printf("TRAFFIC-STATS: %s\n", buf);
+    traffic_stats_format_histogram(buf, sizeof(buf), s->arrival,
+                                   TRAFFIC_STATS_ARRIVAL_BINS);
+    printf("TRAFFIC-STATS: %04x/%u iat %s\n", s->origin, s->flow, buf);
+    if(s->received > 0) {
+      traffic_stats_format_histogram(buf, sizeof(buf), s->latency,
+                                     TRAFFIC_STATS_LATENCY_BINS);
+      printf("TRAFFIC-STATS: %04x/%u lat %s\n", s->origin, s->flow, buf);
+    }
+  }
+  if(traffic_stats_evicted) {
+    printf("TRAFFIC-STATS: evicted %lu\n", (unsigned long)traffic_stats_evicted);
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \file
+ *         Receiver-side statistics of the traffic generator: inter-arrival
+ *         times, delivery ratio, duplicates, reordering, one-way latency
+ *         and jitter, kept per (origin, flow) in a bounded table.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_STATS_H__
+#define __TRAFFIC_STATS_H__
+
+#include "contiki.h"
+
+/* Period of traffic_stats_print() by the traffic process, 0 to disable */
+#ifndef TRAFFIC_STATS_PRINT_INTERVAL
+#define TRAFFIC_STATS_PRINT_INTERVAL (60 * CLOCK_SECOND)
+#endif
+
+/* Number of (origin, flow) pairs tracked. When the table is full, the
+ * least recently seen source makes room for a new one */
+#ifndef TRAFFIC_STATS_MAX_SOURCES
+#define TRAFFIC_STATS_MAX_SOURCES 8
+#endif
+
+/* Histogram bins, in clock ticks: bin 0 counts values of 0 or 1, bin i
+ * values in [2^i, 2^(i+1)), the last bin everything above */
+#ifndef TRAFFIC_STATS_LATENCY_BINS
+#define TRAFFIC_STATS_LATENCY_BINS 12
+#endif
+
+#ifndef TRAFFIC_STATS_ARRIVAL_BINS
+#define TRAFFIC_STATS_ARRIVAL_BINS 16
+#endif
+
+/* Statistics of one (origin, flow) pair. Packets without a traffic header
+ * are accounted for under TRAFFIC_STATS_FLOW_UNKNOWN, with their
+ * inter-arrival times only */
+struct traffic_stats {
+  uint32_t packets;             /* Packets received, including duplicates */
+  uint32_t received;            /* Unique packets received */
+  uint32_t duplicates;          /* Packets received more than once */
+  uint32_t reordered;           /* Packets older than the newest one received */
+  uint32_t jitter;              /* Inter-arrival jitter (RFC 3550), ticks << 4 */
+  uint32_t last_transit;        /* Arrival minus send time of the last packet */
+  uint32_t seen_window;         /* Bit i: packet highest_seq - i was received */
+  uint32_t highest_seq;         /* Extended by the wraps of the 16-bit numbers */
+  clock_time_t last_arrival;
+  clock_time_t last_interval;   /* Time between the last two packets */
+  uint16_t latency[TRAFFIC_STATS_LATENCY_BINS];
+  uint16_t arrival[TRAFFIC_STATS_ARRIVAL_BINS];
+  uint16_t origin;              /* Sender, as in struct traffic_header */
+  uint16_t first_seq;
+  uint16_t max_reorder_depth;   /* Largest highest_seq - seq of a late packet */
+  uint8_t flow;
+  uint8_t used;
+};
+
+#define TRAFFIC_STATS_FLOW_UNKNOWN 0xff
+
+/* Sources evicted from the full table */
+extern uint32_t traffic_stats_evicted;
+
+/**
+ * \brief Account for the arrival of a packet
+ * \param origin Sender of the packet
+ * \param flow Flow id at the sender, TRAFFIC_STATS_FLOW_UNKNOWN if none
+ * \return The statistics of the source
+ */
+struct traffic_stats *traffic_stats_arrival(uint16_t origin, uint8_t flow);
+
+/**
+ * \brief Account for the header of a packet, after traffic_stats_arrival()
+ * \param s Statistics of the source
+ * \param seq Sequence number of the packet in its flow
+ * \param latency Arrival minus send time, in clock ticks
+ */
+void traffic_stats_sequence(struct traffic_stats *s, uint16_t seq,
+                            uint32_t latency);
+
+/**
+ * \brief The statistics of an (origin, flow) pair, NULL if not tracked
+ */
+struct traffic_stats *traffic_stats_lookup(uint16_t origin, uint8_t flow);
+
+/**
+ * \brief Number of packets sent by the source, as seen by the receiver
+ */
+uint32_t traffic_stats_expected(const struct traffic_stats *s);
+
+/**
+ * \brief Packet delivery ratio of the source, in permille
+ */
+uint16_t traffic_stats_pdr(const struct traffic_stats *s);
+
+/**
+ * \brief Iterate over the tracked sources
+ * \param s The previous entry, NULL to get the first one
+ * \return The next entry, NULL at the end of the table
+ */
+struct traffic_stats *traffic_stats_next(struct traffic_stats *s);
+
+/**
+ * \brief Forget all sources
+ */
+void traffic_stats_reset(void);
+
+/**
+ * \brief Format the counters of a source as one line of text
+ * \return The length of the text, as snprintf()
+ */
+int traffic_stats_format(char *buf, int size, const struct traffic_stats *s);
+
+/**
+ * \brief Format a histogram of a source as one line of text
+ * \return The length of the text, as snprintf()
+ */
+int traffic_stats_format_histogram(char *buf, int size, const uint16_t *bins,
+                                   int count);
+
+/**
+ * \brief Print the statistics of every source
+ */
+void traffic_stats_print(void);
+
+#endif /* __TRAFFIC_STATS_H__ */
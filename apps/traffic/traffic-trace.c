@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+/**
+ * \file
+ *       Trace replay for the traffic generator
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ *
+ */
+
+#include "contiki.h"
+#include "traffic-trace.h"
+#if TRAFFIC_TRACE_CFS
+#include "cfs/cfs.h"
+#endif
+
+#include <string.h>
+
+/* Interval used when a trace cannot be read */
+#define FALLBACK_INTERVAL CLOCK_SECOND
+
+/*---------------------------------------------------------------------------*/
+/* The next byte of the trace, -1 at its end */
+static int
+next_byte(struct traffic_trace *trace)
+{
+  if(trace->data != NULL) {
+    if(trace->offset >= trace->length) {
+      return -1;
+    }
+    return trace->data[trace->offset++];
+  }
+#if TRAFFIC_TRACE_CFS
+  if(trace->fd >= 0) {
+    if(trace->buffer_pos == trace->buffer_len) {
+      int len = cfs_read(trace->fd, trace->buffer, sizeof(trace->buffer));
+      if(len <= 0) {
+        return -1;
+      }
+      trace->buffer_len = len;
+      trace->buffer_pos = 0;
+    }
+    return trace->buffer[trace->buffer_pos++];
+  }
+#endif
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns -1 at the end of the trace */
+static int
+next_varint(struct traffic_trace *trace, uint32_t *value)
+{
+  int b;
+  uint8_t shift = 0;
+
+  *value = 0;
+  do {
+    b = next_byte(trace);
+    if(b < 0 || shift > 28) {
+      return -1;
+    }
+    *value |= (uint32_t)(b & 0x7f) << shift;
+    shift += 7;
+  } while(b & 0x80);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+next_record(struct traffic_trace *trace, uint32_t *ms, uint32_t *size)
+{
+  if(next_varint(trace, ms) < 0 || next_varint(trace, size) < 0) {
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Go back to the first record, returns -1 if the header is not valid */
+static int
+restart(struct traffic_trace *trace)
+{
+  uint8_t header[TRAFFIC_TRACE_HEADER_LEN];
+  int i;
+
+  trace->offset = 0;
+#if TRAFFIC_TRACE_CFS
+  if(trace->fd >= 0) {
+    cfs_seek(trace->fd, 0, CFS_SEEK_SET);
+    trace->buffer_pos = trace->buffer_len = 0;
+  }
+#endif
+  for(i = 0; i < TRAFFIC_TRACE_HEADER_LEN; i++) {
+    int b = next_byte(trace);
+    if(b < 0) {
+      return -1;
+    }
+    header[i] = b;
+  }
+  trace->elapsed = 0;
+  return memcmp(header, TRAFFIC_TRACE_MAGIC, TRAFFIC_TRACE_HEADER_LEN) ? -1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(struct traffic_trace *trace, const char **destinations,
+     uint8_t destinations_count, uip_ipaddr_t *resolved)
+{
+  memset(trace, 0, sizeof(struct traffic_trace));
+  traffic_flow_init(&trace->flow, destinations, destinations_count, resolved);
+  trace->flow.get_interval = traffic_trace_get_interval;
+  trace->flow.payload = traffic_trace_payload;
+#if TRAFFIC_TRACE_CFS
+  trace->fd = -1;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_trace_init_array(struct traffic_trace *trace,
+                         const uint8_t *data, uint32_t length,
+                         const char **destinations, uint8_t destinations_count,
+                         uip_ipaddr_t *resolved)
+{
+  init(trace, destinations, destinations_count, resolved);
+  trace->data = data;
+  trace->length = length;
+  if(restart(trace) < 0) {
+    trace->data = NULL;
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#if TRAFFIC_TRACE_CFS
+int
+traffic_trace_init_file(struct traffic_trace *trace, const char *filename,
+                        const char **destinations, uint8_t destinations_count,
+                        uip_ipaddr_t *resolved)
+{
+  init(trace, destinations, destinations_count, resolved);
+  trace->fd = cfs_open(filename, CFS_READ);
+  if(trace->fd < 0) {
+    return -1;
+  }
+  if(restart(trace) < 0) {
+    traffic_trace_close(trace);
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+traffic_trace_close(struct traffic_trace *trace)
+{
+  if(trace->fd >= 0) {
+    cfs_close(trace->fd);
+    trace->fd = -1;
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+uint32_t
+traffic_trace_get_interval(struct traffic_flow *flow)
+{
+  struct traffic_trace *trace = (struct traffic_trace *)flow;
+  uint32_t ms;
+  uint32_t size;
+  uint32_t ticks;
+  uint32_t rem;
+
+  if(next_record(trace, &ms, &size) < 0) {
+    /* End of the trace: start over. A trace that did not advance the clock
+     * would be replayed in a busy loop, pause it instead */
+    ticks = trace->elapsed;
+    if(restart(trace) < 0 || ticks == 0 || next_record(trace, &ms, &size) < 0) {
+      return FALLBACK_INTERVAL;
+    }
+  }
+
+  /* Milliseconds to ticks, carrying the remainder to the next record */
+  ticks = (ms / 1000) * CLOCK_SECOND;
+  rem = (ms % 1000) * CLOCK_SECOND + trace->residue;
+  ticks += rem / 1000;
+  trace->residue = rem % 1000;
+
+  trace->elapsed += ticks;
+#if TRAFFIC_PAYLOAD_HEADER
+  /* A packet smaller than the header would not be sent at all: send the
+   * header alone instead, so that the trace keeps its packet count */
+  if(size < TRAFFIC_HEADER_LEN) {
+    size = TRAFFIC_HEADER_LEN;
+  }
+#endif
+  flow->payload_size = size > 0xffff ? 0xffff : size;
+  return ticks;
+}
+/*---------------------------------------------------------------------------*/
+int
+traffic_trace_payload(char *buffer, int max)
+{
+  memset(buffer, 'x', max);
+  return max;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+ /**
+ *
+ * \file
+ *         Trace replay for the traffic generator: packet intervals and
+ *         sizes are read from a recorded trace instead of being sampled
+ *         from a distribution. The trace is a file in CFS (e.g. Coffee)
+ *         or a const array, generated by traffic-trace.py, and is streamed
+ *         through a small read-ahead buffer.
+ *
+ * \author Georgios Exarchakos <g.exarchakos@tue.nl>
+ */
+
+#ifndef __TRAFFIC_TRACE_H__
+#define __TRAFFIC_TRACE_H__
+
+#include "contiki.h"
+#include "traffic.h"
+
+/* Read traces from CFS files. Without it, only const arrays are replayed */
+#ifndef TRAFFIC_TRACE_CFS
+#define TRAFFIC_TRACE_CFS 0
+#endif
+
+/* Size of the read-ahead buffer of file traces */
+#ifndef TRAFFIC_TRACE_BUFFER_SIZE
+#define TRAFFIC_TRACE_BUFFER_SIZE 32
+#endif
+
+/* Trace format: the 4 header bytes below, then one record per packet:
+ * the interval since the previous packet in milliseconds and the UDP
+ * payload size in bytes, both as LEB128 varints */
+#define TRAFFIC_TRACE_MAGIC "TRC\1"
+#define TRAFFIC_TRACE_HEADER_LEN 4
+
+/**
+ * A flow replaying a trace. The trace restarts from its first record when
+ * it reaches its end.
+ */
+struct traffic_trace {
+  struct traffic_flow flow;              /**< Must be first */
+  const uint8_t *data;                   /**< Const array trace, or NULL */
+  uint32_t length;
+  uint32_t offset;                       /**< Next byte of an array trace */
+#if TRAFFIC_TRACE_CFS
+  int fd;                                /**< File trace, or -1 */
+  uint8_t buffer[TRAFFIC_TRACE_BUFFER_SIZE];
+  uint8_t buffer_pos;
+  uint8_t buffer_len;
+#endif
+  uint16_t residue;                      /**< Sub-tick remainder, in 1/1000 tick */
+  uint32_t elapsed;                      /**< Ticks replayed since the last restart */
+};
+
+/**
+ * \brief Initialize a flow that replays a trace linked in as a const array
+ * \param trace The flow
+ * \param data The trace, including its header
+ * \param length Length of the trace in bytes
+ * \return 0 on success, -1 if the trace has no valid header
+ *
+ * The remaining parameters are as in traffic_flow_init(). Activate the
+ * flow with traffic_flow_add(&trace->flow).
+ */
+int traffic_trace_init_array(struct traffic_trace *trace,
+                             const uint8_t *data, uint32_t length,
+                             const char **destinations,
+                             uint8_t destinations_count,
+                             uip_ipaddr_t *resolved);
+
+#if TRAFFIC_TRACE_CFS
+/**
+ * \brief Initialize a flow that replays a trace file
+ * \param trace The flow
+ * \param filename The CFS file of the trace
+ * \return 0 on success, -1 if the file cannot be read or has no valid header
+ *
+ * The file is kept open until traffic_trace_close().
+ */
+int traffic_trace_init_file(struct traffic_trace *trace, const char *filename,
+                            const char **destinations,
+                            uint8_t destinations_count,
+                            uip_ipaddr_t *resolved);
+
+/**
+ * \brief Close the file of a trace, after traffic_flow_remove()
+ */
+void traffic_trace_close(struct traffic_trace *trace);
+#endif
+
+/**
+ * \brief Interval sampler of trace flows: the interval of the next record,
+ *        whose size becomes the flow's payload_size
+ */
+uint32_t traffic_trace_get_interval(struct traffic_flow *flow);
+
+/**
+ * \brief Payload callback of trace flows: fills all of the payload
+ */
+int traffic_trace_payload(char *buffer, int max);
+
+#endif /* __TRAFFIC_TRACE_H__ */
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016, Georgios Exarchakos
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#
+# Converts a packet trace into the binary format replayed by traffic-trace.c.
+#
+# The input is a CSV file with a header line and at least a "time" column,
+# in seconds, and a "size" column, in bytes, e.g. the output of
+# traffic-log-decode.py. Rows can be filtered on any other column. The
+# output is either the binary trace, to be stored in CFS, or a C array:
+#
+#   ./traffic-trace.py events.csv --where source=3 --where type=tx -o trace.bin
+#   ./traffic-trace.py events.csv --c-array my_trace > my-trace.h
+
+import argparse
+import csv
+import sys
+
+MAGIC = b'TRC\x01'
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def encode(rows):
+    out = bytearray(MAGIC)
+    previous = None
+    for time, size in rows:
+        ms = 0 if previous is None else max(0, round((time - previous) * 1000))
+        previous = time
+        out += varint(ms) + varint(size)
+    return bytes(out)
+
+
+def c_array(name, data, per_line=12):
+    out = ['static const uint8_t %s[%d] = {' % (name, len(data))]
+    for i in range(0, len(data), per_line):
+        out.append('  ' + ', '.join('0x%02x' % b for b in data[i:i + per_line]) + ',')
+    out[-1] = out[-1].rstrip(',')
+    out.append('};')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode traffic traces')
+    parser.add_argument('csv', nargs='?', type=argparse.FileType('r'), default=sys.stdin)
+    parser.add_argument('--where', action='append', default=[], metavar='COLUMN=VALUE',
+                        help='only keep rows with this value, may be repeated')
+    parser.add_argument('-o', '--output', help='binary trace file')
+    parser.add_argument('--c-array', metavar='NAME', help='print a C array instead')
+    args = parser.parse_args()
+
+    filters = [w.split('=', 1) for w in args.where]
+    rows = []
+    for row in csv.DictReader(args.csv):
+        if all(row.get(column) == value for column, value in filters):
+            rows.append((float(row['time']), int(row['size'])))
+    rows.sort()
+    data = encode(rows)
+
+    if args.c_array:
+        print('/* %d packets, generated by traffic-trace.py */' % len(rows))
+        print(c_array(args.c_array, data))
+    elif args.output:
+        with open(args.output, 'wb') as f:
+            f.write(data)
+    else:
+        sys.stdout.buffer.write(data)
+
+
+if __name__ == '__main__':
+    main()
@@ -26,6 +26,7 @@
 
 #include "contiki-conf.h"
 #include "net/netstack.h"
+#include "net/linkaddr.h"
 
 // #define TRAFFIC_ROUTING_RPL
 // #define TRAFFIC_ROUTING_UAODV
@@ -41,7 +42,9 @@
 #endif
 
 #include "net/ip/uip-debug.h"
+#include "lib/list.h"
 #include "lib/random.h"
+#include "lib/prng.h"
 #include "net/ip/uiplib.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,23 +52,96 @@
 #include "net/ip/uip-udp-packet.h"
 
 #include "traffic-conf.h"
+#include "traffic-cdfs.h"
 #include "traffic.h"
 
-#include "net/ip/uip-debug.h"
-#define DEBUG DEBUG_FULL
+#include "traffic-log.h"
+#include "traffic-stats.h"
+#if TRAFFIC_RUNTIME_CONFIG
+#include "traffic-config.h"
+#endif
 
-#if defined TRAFFIC_TRANSMIT_PAYLOAD && defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
-static int total_time = 0;
-static uint32_t interval = 0;
-// static unsigned int interval = 0; //TODO
+/* Per-packet output is text at log level 3 only; level 2 records it in the
+ * binary log instead, see traffic-log.h */
+#if TRAFFIC_LOG_LEVEL >= 1
+#define LOG_INFO(...) printf(__VA_ARGS__)
+#else
+#define LOG_INFO(...)
+#endif
+#if TRAFFIC_LOG_LEVEL >= 3
+#define LOG_PACKET(...) printf(__VA_ARGS__)
+#define LOG_PACKET_ADDR(addr) uip_debug_ipaddr_print(addr)
+#else
+#define LOG_PACKET(...)
+#define LOG_PACKET_ADDR(addr)
+#endif
+
+#if defined TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO \
+  && (TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE != TRAFFIC_CDF_GPD_SHAPE \
+      || TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX != TRAFFIC_CDF_GPD_GENERATION_MAX)
+#error "traffic-cdfs.h does not match the Pareto configuration, regenerate it with traffic-cdfs.py"
+#endif
+#if defined TRAFFIC_NEW_SYSTEM_POISSON && !defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON \
+  && (TRAFFIC_NEW_SYSTEM_POISSON_RATE != TRAFFIC_CDF_POISSON_RATE || TRAFFIC_CDF_POISSON_DISPERSION != 0)
+#error "traffic-cdfs.h does not match the Poisson configuration, regenerate it with traffic-cdfs.py"
+#endif
+#if defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON \
+  && (TRAFFIC_NEW_SYSTEM_POISSON_RATE != TRAFFIC_CDF_POISSON_RATE \
+      || TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON_DISPERSION != TRAFFIC_CDF_POISSON_DISPERSION)
+#error "traffic-cdfs.h does not match the Poisson configuration, regenerate it with traffic-cdfs.py"
 #endif
 
 static struct uip_udp_conn *udp_conn;
 
-// needed for checking interpacket arrival times
-uint32_t previous_arrival_time = 0;
-uint32_t previous_arrival_time_old = 0;
-uint32_t et_arrival_timeout_count = 0;
+/*
+ * Active flows, ordered by next deadline. A single etimer is armed for the
+ * head of the queue, so the process wakes up once per packet regardless of
+ * the number of flows.
+ */
+LIST(flow_queue);
+static struct etimer et;
+static uint8_t next_flow_id = 0;
+#if TRAFFIC_STATS_PRINT_INTERVAL
+static struct etimer et_stats;
+#endif
+
+/* Wrap-around safe "a is before b" on clock_time_t deadlines */
+#define DEADLINE_BEFORE(a, b) ((clock_time_t)((a) - (b)) > ((clock_time_t)~0 >> 1))
+
+#if TRAFFIC_RUNTIME_CONFIG
+/* The flow described by traffic_config */
+static struct traffic_flow default_flow;
+static const char *default_flow_destinations[TRAFFIC_CONFIG_MAX_DESTINATIONS];
+static uip_ipaddr_t default_flow_addrs[TRAFFIC_CONFIG_MAX_DESTINATIONS];
+/* Its parameters in clock ticks */
+static uint32_t config_interval;
+static uint32_t config_deviation;
+static uint32_t config_neg_ln_p;
+#elif defined TRAFFIC_TRANSMIT_PAYLOAD && defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
+/* The flow described by the compile-time TRAFFIC_* configuration */
+static struct traffic_flow default_flow;
+static uip_ipaddr_t default_flow_addrs[TRAFFIC_DESTINATIONS_COUNT];
+#endif
+
+#ifdef TRAFFIC_ROUTING_RPL
+/*
+ * The address whose leading blocks complete a partial destination string,
+ * i.e. the first of our addresses that is in use.
+ */
+static uip_ds6_addr_t *
+traffic_template_addr(void)
+{
+  int i;
+  uint8_t state;
+  for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
+    state = uip_ds6_if.addr_list[i].state;
+    if(uip_ds6_if.addr_list[i].isused && (state == ADDR_TENTATIVE || state == ADDR_PREFERRED)) {
+      return &uip_ds6_if.addr_list[i];
+    }
+  }
+  return NULL;
+}
+#endif
 
 int
 traffic_str_to_ipaddr(uip_ipaddr_t* address, char *na_inbuf, int bufsize)
@@ -117,23 +193,18 @@ traffic_str_to_ipaddr(uip_ipaddr_t* address, char *na_inbuf, int bufsize)
 		prefixsize = 0;
 	}
 
+	/* "::" stands for at least one group of zeros */
+	if(preblocks + postblocks > (prefix && suffix ? 7 : 8)) {
+		return 0;
+	}
 	if(preblocks + postblocks < 8)
 	{
-		int template_found = 0;
-		uint8_t state;
-		for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
-			state = uip_ds6_if.addr_list[i].state;
-			if(uip_ds6_if.addr_list[i].isused && (state == ADDR_TENTATIVE || state == ADDR_PREFERRED))
-			{
-				uip_ipaddr_copy(address, &uip_ds6_if.addr_list[i].ipaddr);
-				template_found = 1;
-				break;
-			}
-		}
-		if(!template_found)
+		uip_ds6_addr_t *template = traffic_template_addr();
+		if(!template)
 		{
 			return 0;
 		}
+		uip_ipaddr_copy(address, &template->ipaddr);
 	}
 	char next_end_char = ':';
 	char *end;
@@ -191,341 +262,645 @@ traffic_transmit_hello(char* buffer, int max)
 
 PROCESS(traffic_process, "Traffic Generator process");
 
-/*unsigned int
-pow(unsigned int x, unsigned int exp)
+/*
+ * Inverse-CDF sampling. Each distribution turns a single 16-bit random draw
+ * into an interval with a couple of table reads (see traffic-cdfs.h) and
+ * fixed-point multiplications, instead of looping over random draws.
+ */
+
+/* Samplers compiled in: those of the enabled distributions, or all of them
+ * when the distribution can be selected at run time */
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_EXPONENTIAL
+#define WITH_EXPONENTIAL 1
+#endif
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_GEOMETRIC
+#define WITH_GEOMETRIC 1
+#endif
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_NORMAL
+#define WITH_NORMAL 1
+#endif
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO
+#define WITH_GPD 1
+#endif
+#if TRAFFIC_RUNTIME_CONFIG || defined TRAFFIC_NEW_SYSTEM_POISSON \
+  || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON
+#define WITH_POISSON 1
+#endif
+
+#if WITH_EXPONENTIAL || WITH_NORMAL || WITH_GPD
+/* scale * q, with q in 16.16 fixed point, without a 64-bit multiplication.
+ * Both are split in 16-bit halves so that no partial product overflows */
+static uint32_t
+scale_q16(uint32_t scale, uint32_t q)
 {
-	result = 1;
-	unsigned int i = 0;
-	while(i < exp) {
-		result *= x;
-		i++;
-	}
-}*/
-
-#define fracnegpow(a, b, c) fracpow((b), (a), (c))
-unsigned int
-fracpow(unsigned int num, unsigned int den, unsigned int exp)
-{
-	unsigned int result = 1;
-	unsigned int i = 0;
-	while(i < exp) {
-		printf("%u * %u\n", result, num);
-		result *= num;
-		i++;
-	}
-	i = 0;
-	while(i < exp - 1) {
-		printf("%u / %u\n", result, den);
-		result /= den;
-		i++;
-	}
-	return result;
+  uint32_t s_hi = scale >> 16, s_lo = scale & 0xffff;
+  uint32_t q_hi = q >> 16, q_lo = q & 0xffff;
+  return ((s_hi * q_hi) << 16) + s_hi * q_lo + s_lo * q_hi
+    + ((s_lo * q_lo) >> 16);
+}
+#endif
+
+#if WITH_EXPONENTIAL || WITH_GEOMETRIC || WITH_NORMAL || WITH_GPD
+/* Interpolate the quantile of u between the two surrounding table entries */
+static uint32_t
+cdf_lookup(const uint32_t *table, uint16_t u)
+{
+  uint32_t lo = table[u >> (16 - TRAFFIC_CDF_TABLE_BITS)];
+  uint32_t diff = table[(u >> (16 - TRAFFIC_CDF_TABLE_BITS)) + 1] - lo;
+  uint8_t frac = u & ((1 << (16 - TRAFFIC_CDF_TABLE_BITS)) - 1);
+  return lo + (diff >> 8) * frac + (((diff & 0xff) * frac) >> 8);
 }
+#endif
 
-/*#define fracnegpow(a, b, c) fracpow((b), (a), (c))
-#define fracpow(a, b, c) (fracpow2frac((a), (b), (c)) / (b))
-#define fracnegpow2frac(a, b, c) fracpow((b), (a), (c))
-unsigned int
-fracpow2frac(unsigned int num, unsigned int den, unsigned int exp)
+/* One 16-bit draw from the stream of the flow */
+#define DRAW(flow) ((uint16_t)(prng_next32(&(flow)->prng) >> 16))
+
+static uint32_t
+add_saturated(uint32_t delay, uint32_t add)
 {
-	unsigned int result = 1;
-	unsigned int i = 0;
-	while(i < exp) {
-		printf("%u * %u\n", result, num);
-		result *= num;
-		i++;
-	}
-	i = 0;
-	while(i < exp - 1) {
-		printf("%u / %u\n", result, den);
-		result /= den;
-		i++;
-	}
-	return result;
-}*/
-
-/*unsigned int
-sqrt(unsigned int num) {
-    short res = 0;
-    short bit = 1 << 14; // The second-to-top bit is set: 1 << 30 for 32 bits
- 
-    // "bit" starts at the highest power of four <= the argument.
-    while (bit > num)
-        bit >>= 2;
-        
-    while (bit != 0) {
-        if (num >= res + bit) {
-            num -= res + bit;
-            res = (res >> 1) + bit;
-        }
-        else
-            res >>= 1;
-        bit >>= 2;
-    }
-    return res;
-}*/
+  return delay + add < delay ? 0xffffffff : delay + add;
+}
+
+/* The samplers below return clock ticks; their parameters are in ticks too */
+#if WITH_EXPONENTIAL
+static uint32_t
+sample_exponential(struct traffic_flow *flow, uint32_t mean)
+{
+  return scale_q16(mean, cdf_lookup(traffic_cdf_exponential, DRAW(flow)));
+}
+#endif
+
+#if WITH_GEOMETRIC
+/* -ln(p) in 16.16 fixed point, p being the per step continuation
+ * probability as a fraction of 65535 */
+static uint32_t
+geometric_neg_ln_p(uint16_t probability)
+{
+  uint32_t neg_ln_p = cdf_lookup(traffic_cdf_exponential, 65535 - probability);
+  return neg_ln_p == 0 ? 1 : neg_ln_p;
+}
+
+/* Number of steps until the first success: 1 + floor(-ln(1 - u) / -ln(p)) */
+static uint32_t
+sample_geometric(struct traffic_flow *flow, uint32_t neg_ln_p, uint32_t step)
+{
+  return (1 + cdf_lookup(traffic_cdf_exponential, DRAW(flow)) / neg_ln_p) * step;
+}
+#endif
+
+#if WITH_NORMAL
+/* Negative samples are truncated to 0 */
+static uint32_t
+sample_normal(struct traffic_flow *flow, uint32_t mean, uint32_t deviation)
+{
+  int32_t offset = (int32_t)cdf_lookup((const uint32_t *)traffic_cdf_normal, DRAW(flow));
+  if(offset < 0) {
+    offset = -(int32_t)scale_q16(deviation, -offset);
+  } else {
+    offset = scale_q16(deviation, offset);
+  }
+  offset += (int32_t)mean;
+  return offset > 0 ? offset : 0;
+}
+#endif
+
+#if WITH_GPD
+static uint32_t
+sample_gpd(struct traffic_flow *flow, uint32_t location, uint32_t scale)
+{
+  return location + scale_q16(scale, cdf_lookup(traffic_cdf_gpd, DRAW(flow)));
+}
+#endif
+
+#if WITH_POISSON
+/* The rate is that of the table, unit is the duration of one count */
+static uint32_t
+sample_poisson(struct traffic_flow *flow, uint32_t unit)
+{
+  uint16_t u = DRAW(flow);
+  uint8_t k = traffic_cdf_poisson_guide[u >> 8];
+  while(k < TRAFFIC_CDF_POISSON_SIZE - 1 && u >= traffic_cdf_poisson[k]) {
+    k++;
+  }
+  return k * unit;
+}
+#endif
 
 uint32_t
-// unsigned int //TODO
-get_interval()
-{
-	uint32_t delay = 0; //TODO
-	uint32_t olddelay;
-	uint32_t rand;
-// 	unsigned int delay = 0; //TODO
-// 	unsigned int olddelay;
-// 	unsigned int rand;
-	
-// 	delay = random_rand() * 65536 + random_rand();
-// 	printf("Randval: %"PRIu32"\n", delay);
-// 	delay = 0;
-	
+get_interval(struct traffic_flow *flow)
+{
+  uint32_t delay = 0;
+#ifdef TRAFFIC_NEW_SYSTEM_GEOMETRIC
+  static uint32_t neg_ln_p = 0;
+  if(neg_ln_p == 0) {
+    neg_ln_p = geometric_neg_ln_p(TRAFFIC_NEW_SYSTEM_GEOMETRIC_PROBABILITY);
+  }
+#endif
+
 #ifdef TRAFFIC_NEW_SYSTEM_DELTA
-	delay += TRAFFIC_NEW_SYSTEM_DELTA_MEAN * CLOCK_SECOND;
-#endif
-	
-#ifdef TRAFFIC_NEW_SYSTEM_UNIFORM //TODO
-	rand = (random_rand() << 16) | random_rand();
-#ifdef TRAFFIC_NEW_SYSTEM_PRECISE
-#if TRAFFIC_NEW_SYSTEM_UNIFORM_MAX < 65536
-	unsigned int limit = 65535 - (65535 % (TRAFFIC_NEW_SYSTEM_UNIFORM_MAX * CLOCK_SECOND));
-#else
-	unsigned int limit = 4294967295 - (4294967295 % (TRAFFIC_NEW_SYSTEM_UNIFORM_MAX * CLOCK_SECOND));
+  delay = add_saturated(delay, (uint32_t)TRAFFIC_NEW_SYSTEM_DELTA_MEAN * CLOCK_SECOND);
 #endif
-	unsigned int counter = 0;
-	while(rand >= limit && counter < 50){
-		rand = random_rand();
-#if TRAFFIC_NEW_SYSTEM_UNIFORM_MAX > 65535
-		rand |= random_rand() << 16;
+#ifdef TRAFFIC_NEW_SYSTEM_UNIFORM
+  delay = add_saturated(delay, prng_bounded(&flow->prng, (uint32_t)TRAFFIC_NEW_SYSTEM_UNIFORM_MAX * CLOCK_SECOND));
 #endif
-		counter++;
-	}
+#ifdef TRAFFIC_NEW_SYSTEM_EXPONENTIAL
+  delay = add_saturated(delay, sample_exponential(flow, (uint32_t)TRAFFIC_NEW_SYSTEM_EXPONENTIAL_MEAN * CLOCK_SECOND));
 #endif
-	olddelay = delay;
-	delay += rand % (TRAFFIC_NEW_SYSTEM_UNIFORM_MAX * CLOCK_SECOND);
-	if(olddelay > delay) {
-		delay = 65535;
-	}
+#ifdef TRAFFIC_NEW_SYSTEM_GEOMETRIC
+  delay = add_saturated(delay, sample_geometric(flow, neg_ln_p, CLOCK_SECOND / TRAFFIC_NEW_SYSTEM_GEOMETRIC_DOWNSCALE));
 #endif
-#ifdef TRAFFIC_NEW_SYSTEM_GEOMETRIC //TODO
-	rand = random_rand();
-	unsigned int step = 1;
-	while(step < 500 && rand < TRAFFIC_NEW_SYSTEM_GEOMETRIC_PROBABILITY) {
-		rand = random_rand();
-		step++;
-	}
-	olddelay = delay;
-	delay += step * CLOCK_SECOND / TRAFFIC_NEW_SYSTEM_GEOMETRIC_DOWNSCALE;
-	if(olddelay > delay) {
-		delay = 65535;
-	}
+#ifdef TRAFFIC_NEW_SYSTEM_NORMAL
+  delay = add_saturated(delay, sample_normal(flow, (uint32_t)TRAFFIC_NEW_SYSTEM_NORMAL_MEAN * CLOCK_SECOND,
+                                             (uint32_t)TRAFFIC_NEW_SYSTEM_NORMAL_STANDARD_DEVIATION * CLOCK_SECOND));
 #endif
-#ifdef TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO //TODO
-	rand = random_rand();
-#ifdef TRAFFIC_NEW_SYSTEM_PRECISE
-	unsigned int limit = 65535 - (65535 % TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX);
-	unsigned int counter = 0;
-	while(rand >= limit && counter < 50){
-		rand = random_rand();
-		counter++;
-	}
+#ifdef TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO
+  delay = add_saturated(delay, sample_gpd(flow, (uint32_t)TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN * CLOCK_SECOND,
+                                          (uint32_t)TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION * CLOCK_SECOND));
 #endif
-	rand %= TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX;
-	printf("Got rand: %u\n", rand);
-	rand = fracpow(TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX, rand, TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE);
-	printf("Powerized rand: %u\n", rand);
-	rand = (rand - 1) * TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION / TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE + TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN;
-	printf("Final rand: %u\n", rand);
-	olddelay = delay;
-	delay += rand;
-	if(olddelay > delay) {
-		delay = 65535;
-	}
+#if defined TRAFFIC_NEW_SYSTEM_POISSON || defined TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON
+  delay = add_saturated(delay, sample_poisson(flow, CLOCK_SECOND));
 #endif
-#ifdef TRAFFIC_NEW_SYSTEM_GENERALIZED_POISSON //TODO
-	rand = random_rand();
-#ifdef TRAFFIC_NEW_SYSTEM_PRECISE
-	unsigned int limit = 65535 - (65535 % TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX);
-	unsigned int counter = 0;
-	while(rand >= limit && counter < 50){
-		rand = random_rand();
-		counter++;
-	}
+
+  if(delay == 0) {
+    delay = 1;
+  }
+
+  return delay;
+}
+
+/*
+ * Each flow keeps its destination strings resolved to addresses, with our own
+ * address(es) filtered out. Picking a destination is then a single index into
+ * that table. The tables are re-resolved only when the addresses they were
+ * built from change: any of the addresses in use, as the first completes
+ * partial destination strings and all are filtered out.
+ */
+#ifdef TRAFFIC_ROUTING_RPL
+static uip_ipaddr_t destinations_own_addr[UIP_DS6_ADDR_NB];
+static uint8_t destinations_own_used[UIP_DS6_ADDR_NB];
+static uint8_t destinations_resolved = 0;
 #endif
-	rand %= TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX;
-	printf("Got rand: %u\n", rand);
-	rand = fracpow(TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_GENERATION_MAX, rand, TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE);
-	printf("Powerized rand: %u\n", rand);
-	rand = (rand - 1) * TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_STANDARD_DEVIATION / TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_SHAPE + TRAFFIC_NEW_SYSTEM_GENERALIZED_PARETO_MEAN;
-	printf("Final rand: %u\n", rand);
-	olddelay = delay;
-	delay += rand;
-	if(olddelay > delay) {
-		delay = 65535;
-	}
+#ifdef TRAFFIC_ROUTING_UAODV
+static uint8_t destinations_host = 0;
 #endif
-	
-	if(delay == 0) {
-		delay = 1;
-	}
-	
-// 	printf("interval: %"PRIu32"\n", delay);
-// 	printf("interval: %i%i%i%i%i%i%i%i\n", delay % 10, (delay % 100)/10, (delay % 1000)/100, (delay % 10000)/1000, (delay % 100000)/10000, (delay % 1000000)/100000, (delay % 10000000)/1000000, (delay % 100000000)/10000000);
-	
-	return delay;
+
+#ifdef TRAFFIC_ROUTING_RPL
+static int
+own_addr_used(int i)
+{
+  uint8_t state = uip_ds6_if.addr_list[i].state;
+  return uip_ds6_if.addr_list[i].isused && (state == ADDR_TENTATIVE || state == ADDR_PREFERRED);
+}
+
+static int
+is_own_addr(uip_ipaddr_t *addr)
+{
+  int i;
+  for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
+    if(own_addr_used(i) && uip_ipaddr_cmp(&uip_ds6_if.addr_list[i].ipaddr, addr)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif
+
+static void
+resolve_flow_destinations(struct traffic_flow *flow)
+{
+  int i;
+  flow->resolved_count = 0;
+  for(i = 0; i < flow->destinations_count; i++) {
+#ifdef TRAFFIC_ROUTING_RPL
+    const char *addr_str = flow->destinations[i];
+    if(traffic_str_to_ipaddr(&flow->resolved[flow->resolved_count], (char *)addr_str, strlen(addr_str) + 1)
+       && !is_own_addr(&flow->resolved[flow->resolved_count])) {
+      flow->resolved_count++;
+    }
+#endif
+#ifdef TRAFFIC_ROUTING_UAODV
+    if((uint8_t)(uintptr_t)flow->destinations[i] != destinations_host) {
+      uip_ipaddr(&flow->resolved[flow->resolved_count], 172, 16, (uint8_t)(uintptr_t)flow->destinations[i], 0);
+      flow->resolved_count++;
+    }
+#endif
+  }
+  LOG_INFO("TRAFFIC: flow %u, %u destination(s) resolved\n", flow->id, flow->resolved_count);
+}
+
+static void
+resolve_destinations(void)
+{
+  struct traffic_flow *flow;
+#ifdef TRAFFIC_ROUTING_RPL
+  int i;
+  for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
+    destinations_own_used[i] = own_addr_used(i);
+    uip_ipaddr_copy(&destinations_own_addr[i], &uip_ds6_if.addr_list[i].ipaddr);
+  }
+  destinations_resolved = 1;
+#endif
+#ifdef TRAFFIC_ROUTING_UAODV
+  destinations_host = uip_hostaddr.u8[2];
+#endif
+  for(flow = list_head(flow_queue); flow != NULL; flow = list_item_next(flow)) {
+    resolve_flow_destinations(flow);
+  }
+}
+
+/* Check whether the tables were built from our current addresses, in time
+ * linear in UIP_DS6_ADDR_NB only */
+static int
+destinations_stale(void)
+{
+#ifdef TRAFFIC_ROUTING_RPL
+  int i;
+  if(!destinations_resolved) {
+    return 1;
+  }
+  for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
+    if(own_addr_used(i) != destinations_own_used[i]
+       || (destinations_own_used[i]
+           && !uip_ipaddr_cmp(&uip_ds6_if.addr_list[i].ipaddr, &destinations_own_addr[i]))) {
+      return 1;
+    }
+  }
+  return 0;
+#endif
+#ifdef TRAFFIC_ROUTING_UAODV
+  return destinations_host != uip_hostaddr.u8[2];
+#endif
+  return 0;
+}
+
+static uip_ipaddr_t *
+pick_destination(struct traffic_flow *flow)
+{
+  if(flow->resolved_count == 0) {
+    return NULL;
+  }
+  return &flow->resolved[prng_bounded16(&flow->prng, flow->resolved_count)];
+}
+
+/* Insert a flow in the queue, keeping it sorted by deadline */
+static void
+schedule_flow(struct traffic_flow *flow)
+{
+  struct traffic_flow *prev = NULL;
+  struct traffic_flow *f;
+
+  for(f = list_head(flow_queue); f != NULL; f = list_item_next(f)) {
+    if(DEADLINE_BEFORE(flow->deadline, f->deadline)) {
+      break;
+    }
+    prev = f;
+  }
+  list_insert(flow_queue, prev, flow);
+}
+
+/* Arm the process timer for the earliest deadline in the queue */
+static void
+arm_timer(void)
+{
+  struct traffic_flow *head = list_head(flow_queue);
+  clock_time_t now = clock_time();
+
+  if(head == NULL) {
+    etimer_stop(&et);
+    return;
+  }
+  PROCESS_CONTEXT_BEGIN(&traffic_process);
+  if(DEADLINE_BEFORE(head->deadline, now)) {
+    etimer_set(&et, 0);
+  } else {
+    etimer_set(&et, head->deadline - now);
+  }
+  PROCESS_CONTEXT_END(&traffic_process);
+}
+
+#if TRAFFIC_PAYLOAD_HEADER
+static void
+write_header(uint8_t *buffer, const struct traffic_header *header)
+{
+  buffer[0] = TRAFFIC_HEADER_MAGIC;
+  buffer[1] = header->flow;
+  buffer[2] = header->origin >> 8;
+  buffer[3] = header->origin & 0xff;
+  buffer[4] = header->seq >> 8;
+  buffer[5] = header->seq & 0xff;
+  buffer[6] = header->timestamp >> 24;
+  buffer[7] = (header->timestamp >> 16) & 0xff;
+  buffer[8] = (header->timestamp >> 8) & 0xff;
+  buffer[9] = header->timestamp & 0xff;
+}
+
+/* Returns 0 if the buffer does not start with a traffic header */
+static int
+read_header(const uint8_t *buffer, int len, struct traffic_header *header)
+{
+  if(len < TRAFFIC_HEADER_LEN || buffer[0] != TRAFFIC_HEADER_MAGIC) {
+    return 0;
+  }
+  header->flow = buffer[1];
+  header->origin = ((uint16_t)buffer[2] << 8) | buffer[3];
+  header->seq = ((uint16_t)buffer[4] << 8) | buffer[5];
+  header->timestamp = ((uint32_t)buffer[6] << 24) | ((uint32_t)buffer[7] << 16)
+    | ((uint32_t)buffer[8] << 8) | buffer[9];
+  return 1;
+}
+
+static uint16_t
+node_origin(void)
+{
+  return ((uint16_t)linkaddr_node_addr.u8[LINKADDR_SIZE - 2] << 8)
+    | linkaddr_node_addr.u8[LINKADDR_SIZE - 1];
+}
+#endif
+
+static void
+transmit(struct traffic_flow *flow)
+{
+  uip_ipaddr_t *destination = pick_destination(flow);
+
+  if(destination != NULL) {
+    /* The payload is written in place, in the outgoing packet buffer */
+    char *buffer = UIP_UDP_PACKET_APPDATA;
+    int max = MIN(flow->payload_size, UIP_UDP_PACKET_APPDATA_SIZE);
+    int siz;
+#if TRAFFIC_PAYLOAD_HEADER
+    struct traffic_header header;
+
+    if(max < TRAFFIC_HEADER_LEN) {
+      LOG_INFO("TRAFFIC: payload of flow %u too small for the header\n", flow->id);
+      return;
+    }
+    header.flow = flow->id;
+    header.origin = node_origin();
+    header.seq = flow->seq;
+    header.timestamp = TRAFFIC_TIMESTAMP();
+    write_header((uint8_t *)buffer, &header);
+    siz = TRAFFIC_HEADER_LEN
+      + flow->payload(buffer + TRAFFIC_HEADER_LEN, max - TRAFFIC_HEADER_LEN);
+#else
+    siz = flow->payload(buffer, max);
+#endif
+    LOG_PACKET("TRAFFIC: %u -> [", flow->id);
+    LOG_PACKET_ADDR(destination);
+    LOG_PACKET("]:%u, %d bytes //after delay of %"PRIu32"\n", flow->port, siz, flow->interval);
+    TRAFFIC_LOG_ADD(TRAFFIC_LOG_TX, flow->id, destination, flow->seq, siz);
+    flow->seq++;
+#ifdef TRAFFIC_ROUTING_UAODV
+    /* Held back by uAODV until the route to the destination is found */
+    if(uaodv_sendto(udp_conn, buffer, siz, destination, UIP_HTONS(flow->port)) == UAODV_DROPPED) {
+      LOG_PACKET("TRAFFIC: no route from %d.%d.%d.%d to %d.%d.%d.%d, dropped\n", uip_ipaddr_to_quad(&uip_hostaddr), uip_ipaddr_to_quad(destination));
+    }
+#else
+    uip_udp_packet_sendto(udp_conn, buffer, siz, destination, UIP_HTONS(flow->port));
+#endif
+  }
+}
+
+/* Serve every flow whose deadline has passed and put it back in the queue */
+static void
+serve_flows(void)
+{
+  struct traffic_flow *flow;
+
+  if(destinations_stale()) {
+    resolve_destinations();
+  }
+  while((flow = list_head(flow_queue)) != NULL
+        && !DEADLINE_BEFORE(clock_time(), flow->deadline)) {
+    list_pop(flow_queue);
+    transmit(flow);
+    flow->interval = flow->get_interval(flow);
+    flow->deadline += flow->interval;
+    LOG_PACKET("interval: %"PRIu32"\n", flow->interval);
+    schedule_flow(flow);
+  }
+  arm_timer();
+}
+
+static void
+log_receive(const struct traffic_stats *s, uint16_t seq, const char *payload)
+{
+  LOG_PACKET("TRAFFIC: <- [");
+  LOG_PACKET_ADDR(&UIP_IP_BUF->srcipaddr);
+  LOG_PACKET("]:, %u/%u \"%s\", after %lu ticks\n", s->flow, seq, payload, (unsigned long)s->last_interval);
+  TRAFFIC_LOG_ADD(TRAFFIC_LOG_RX, s->flow, &UIP_IP_BUF->srcipaddr, seq, uip_datalen());
+}
+
+/* Account for the packet in uip_appdata and pass it on */
+static void
+receive(void)
+{
+  char *payload = (char *)uip_appdata;
+  struct traffic_stats *s;
+#if TRAFFIC_PAYLOAD_HEADER
+  struct traffic_header header;
+  uint32_t latency;
+#endif
+
+  ((char *)uip_appdata)[uip_datalen()] = '\0';
+
+#if TRAFFIC_PAYLOAD_HEADER
+  if(read_header((uint8_t *)uip_appdata, uip_datalen(), &header)) {
+    latency = (uint32_t)clock_time() - header.timestamp;
+    /* Clocks that are not perfectly aligned can make it negative */
+    if((int32_t)latency < 0) {
+      latency = 0;
+    }
+    s = traffic_stats_arrival(header.origin, header.flow);
+    traffic_stats_sequence(s, header.seq, latency);
+    payload += TRAFFIC_HEADER_LEN;
+    log_receive(s, header.seq, payload);
+  } else
+#endif
+  {
+    /* Without a header, the source address identifies the sender */
+    s = traffic_stats_arrival(
+      ((uint16_t)UIP_IP_BUF->srcipaddr.u8[sizeof(uip_ipaddr_t) - 2] << 8)
+      | UIP_IP_BUF->srcipaddr.u8[sizeof(uip_ipaddr_t) - 1],
+      TRAFFIC_STATS_FLOW_UNKNOWN);
+    log_receive(s, 0, payload);
+  }
+
+#ifdef TRAFFIC_RECEIVE_CALLBACK
+  TRAFFIC_RECEIVE_CALLBACK(&UIP_IP_BUF->srcipaddr, uip_ntohs(UIP_UDP_BUF->srcport), payload);
+#endif
+}
+
+void
+traffic_flow_init(struct traffic_flow *flow, const char **destinations,
+                  uint8_t destinations_count, uip_ipaddr_t *resolved)
+{
+  memset(flow, 0, sizeof(struct traffic_flow));
+  flow->destinations = destinations;
+  flow->destinations_count = destinations_count;
+  flow->resolved = resolved;
+  flow->port = TRAFFIC_PORT;
+  flow->payload_size = UIP_APPDATA_SIZE;
+  flow->get_interval = get_interval;
+#ifdef TRAFFIC_TRANSMIT_PAYLOAD
+  flow->payload = TRAFFIC_TRANSMIT_PAYLOAD;
+#else
+  flow->payload = traffic_transmit_hello;
+#endif
+}
+
+/* Draw the first interval of a flow and queue it */
+static void
+start_flow(struct traffic_flow *flow)
+{
+  flow->interval = flow->get_interval(flow);
+  flow->deadline = clock_time() + flow->interval;
+  LOG_INFO("TRAFFIC: flow %u, interval: %"PRIu32"\n", flow->id, flow->interval);
+  resolve_flow_destinations(flow);
+  schedule_flow(flow);
+  if(process_is_running(&traffic_process)) {
+    arm_timer();
+  }
+}
+
+void
+traffic_flow_add(struct traffic_flow *flow)
+{
+  traffic_flow_remove(flow);
+  flow->id = next_flow_id++;
+  prng_seed_lladdr(&flow->prng, PRNG_STREAM_TRAFFIC + flow->id);
+  start_flow(flow);
 }
 
 void
-set_destination(uip_ipaddr_t *destination)
+traffic_flow_remove(struct traffic_flow *flow)
 {
+  list_remove(flow_queue, flow);
+  if(process_is_running(&traffic_process)) {
+    arm_timer();
+  }
+}
+
+#if TRAFFIC_RUNTIME_CONFIG
+static uint32_t
+ms_to_ticks(uint32_t ms)
+{
+  return (ms / 1000) * CLOCK_SECOND + (ms % 1000) * CLOCK_SECOND / 1000;
+}
+
+static uint32_t
+config_get_interval(struct traffic_flow *flow)
+{
+  uint32_t delay;
+
+  switch(traffic_config.distribution) {
+  case TRAFFIC_DISTRIBUTION_UNIFORM:
+    delay = prng_bounded(&flow->prng, config_interval);
+    break;
+  case TRAFFIC_DISTRIBUTION_EXPONENTIAL:
+    delay = sample_exponential(flow, config_interval);
+    break;
+  case TRAFFIC_DISTRIBUTION_GEOMETRIC:
+    delay = sample_geometric(flow, config_neg_ln_p, config_interval);
+    break;
+  case TRAFFIC_DISTRIBUTION_NORMAL:
+    delay = sample_normal(flow, config_interval, config_deviation);
+    break;
+  case TRAFFIC_DISTRIBUTION_PARETO:
+    delay = sample_gpd(flow, config_interval, config_deviation);
+    break;
+  case TRAFFIC_DISTRIBUTION_POISSON:
+    delay = sample_poisson(flow, config_interval);
+    break;
+  default:
+    delay = config_interval;
+    break;
+  }
+  return delay == 0 ? 1 : delay;
+}
+
+static void
+apply_config(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < traffic_config.destinations_count; i++) {
 #ifdef TRAFFIC_ROUTING_UAODV
-	unsigned int rand;
-	uip_ipaddr_t hostaddr;
-	
-	rand = random_rand() % TRAFFIC_DESTINATIONS_COUNT;
-	while(TRAFFIC_DESTINATIONS[rand] == uip_hostaddr.u8[2]) {
-		rand = random_rand() % TRAFFIC_DESTINATIONS_COUNT;
-	}
-	uip_ipaddr(destination, 172, 16, TRAFFIC_DESTINATIONS[rand], 0);
+    /* Host numbers, as in TRAFFIC_DESTINATIONS */
+    default_flow_destinations[i] = (const char *)(uintptr_t)atoi(traffic_config.destinations[i]);
+#else
+    default_flow_destinations[i] = traffic_config.destinations[i];
 #endif
+  }
+  default_flow.destinations_count = traffic_config.destinations_count;
+  default_flow.port = traffic_config.port;
+  default_flow.payload_size = traffic_config.payload_size;
+  config_interval = ms_to_ticks(traffic_config.interval);
+  config_deviation = ms_to_ticks(traffic_config.deviation);
+  config_neg_ln_p = geometric_neg_ln_p(traffic_config.probability);
 }
 
+void
+traffic_reconfigure(void)
+{
+  if(process_is_running(&traffic_process)) {
+    apply_config();
+    /* Restart the flow, so that the new distribution applies right away */
+    list_remove(flow_queue, &default_flow);
+    start_flow(&default_flow);
+  }
+}
+#endif
+
 PROCESS_THREAD(traffic_process, ev, data)
 {
+  PROCESS_EXITHANDLER(list_init(flow_queue));
   PROCESS_BEGIN();
-  printf("TRAFFIC: process started\n");
+  LOG_INFO("TRAFFIC: process started\n");
+  traffic_log_init();
   
   /* Listen to any host */
   udp_conn = udp_new(NULL, 0, NULL);
   udp_bind(udp_conn, UIP_HTONS(TRAFFIC_PORT));
   /* Wait for timer event 
-     On timer event, handle next sample */
-  
-#if defined TRAFFIC_TRANSMIT_PAYLOAD && defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
-  printf("Creating timer.\n");
-  static struct etimer et;
-  
-  interval = get_interval();
+     On timer event, serve the flows that are due */
   
-// #ifdef TRAFFIC_SHRINK_FACTOR
-//   interval = interval >> TRAFFIC_CDF_SHRINK_FACTOR;
-// #endif
-  
-  printf("interval: %"PRIu32"\n", interval);
-  etimer_set(&et, interval);
+  resolve_destinations();
+#if TRAFFIC_RUNTIME_CONFIG
+  traffic_config_init();
+  traffic_flow_init(&default_flow, default_flow_destinations, 0, default_flow_addrs);
+  default_flow.get_interval = config_get_interval;
+  apply_config();
+  traffic_flow_add(&default_flow);
+#elif defined TRAFFIC_TRANSMIT_PAYLOAD && defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
+  traffic_flow_init(&default_flow, (const char **)TRAFFIC_DESTINATIONS,
+                    TRAFFIC_DESTINATIONS_COUNT, default_flow_addrs);
+  traffic_flow_add(&default_flow);
 #endif
+  arm_timer();
   
-  static struct etimer et_arrival_timeout;
-  etimer_set(&et_arrival_timeout, 20000);
+#if TRAFFIC_STATS_PRINT_INTERVAL
+  etimer_set(&et_stats, TRAFFIC_STATS_PRINT_INTERVAL);
+#endif
   while(1) {
-// 	printf("start of loop: %u\n", previous_arrival_time);
     PROCESS_WAIT_EVENT();
-// 	printf("got event: %u\n", previous_arrival_time);
     if (ev == tcpip_event) {
       if(uip_newdata()) {
-// 		printf("oldnew: %u\n", previous_arrival_time);
-		previous_arrival_time_old = previous_arrival_time;
-		previous_arrival_time = clock_time();
-// 		printf("%u\n", previous_arrival_time);
-// 		printf("%u\n", previous_arrival_time_old);
-// 		printf("%u\n", previous_arrival_time - previous_arrival_time_old);
-        ((char *)uip_appdata)[uip_datalen()] = '\0';
-        printf("TRAFFIC: <- [");
-		uip_debug_ipaddr_print(&UIP_IP_BUF->srcipaddr);
-		printf("]:, \"%s\", after %"PRIu32" second fractions\n", (char *)uip_appdata, previous_arrival_time - previous_arrival_time_old);
-		et_arrival_timeout_count = 0;
-		etimer_restart(&et_arrival_timeout);
-// 		printf("after: %u\n", previous_arrival_time);
-		
-#ifdef TRAFFIC_RECEIVE_CALLBACK
-        TRAFFIC_RECEIVE_CALLBACK(&UIP_IP_BUF->srcipaddr, uip_ntohs(UIP_UDP_BUF->srcport), (char *)uip_appdata);
-#endif
-		
+        receive();
       }
     }
     
-    if (etimer_expired(&et_arrival_timeout)) {
-		et_arrival_timeout_count++;
-		etimer_reset(&et_arrival_timeout);
-	}
-	
-#if defined TRAFFIC_TRANSMIT_PAYLOAD && defined TRAFFIC_DESTINATIONS && TRAFFIC_DESTINATIONS_COUNT
-#ifdef TRAFFIC_ROUTING_RPL
-#ifdef TRAFFIC_SINGLE_BORDER_ROUTER_DESTINATION //TODO: Contiki can't get ipv6 hostaddr?
-	if (etimer_expired(&et)) {
-#else
-	uip_ipaddr_t tmp_addr;
-	uip_ipaddr_t host_addr;
-#if TRAFFIC_DESTINATIONS_COUNT == 1
-	traffic_str_to_ipaddr(&tmp_addr, TRAFFIC_DESTINATIONS[0], strlen(TRAFFIC_DESTINATIONS[0])+1);
-	uip_gethostaddr(&host_addr);
-#endif
-    if (etimer_expired(&et) && (TRAFFIC_DESTINATIONS_COUNT > 1 || uip_ipaddr_cmp(&tmp_addr, &host_addr))) {
-#endif
-#endif
-#ifdef TRAFFIC_ROUTING_UAODV
-    if (etimer_expired(&et) && (TRAFFIC_DESTINATIONS_COUNT > 1 || TRAFFIC_DESTINATIONS[0] != uip_hostaddr.u8[2])) {
-#endif
-      total_time += interval;
-      uip_ipaddr_t destination;
-	  int skip = 0;
-#ifdef TRAFFIC_ROUTING_RPL
-	  char *addr_str = (char*)TRAFFIC_DESTINATIONS[random_rand() % TRAFFIC_DESTINATIONS_COUNT];
-      traffic_str_to_ipaddr(&destination,addr_str,strlen(addr_str)+1);
-	  int i;
-      uint8_t state;
-      for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
-        state = uip_ds6_if.addr_list[i].state;
-        if((uip_ds6_if.addr_list[i].isused && (state == ADDR_TENTATIVE || state == ADDR_PREFERRED))
-			&& (uip_ipaddr_cmp(&uip_ds6_if.addr_list[i].ipaddr,&destination)))
-        {
-			skip = 1;
-			break;
-		}
-	  }  
-#endif
-#ifdef TRAFFIC_ROUTING_UAODV
-      struct uaodv_rt_entry *route;
-	  
-
-//       uip_ipaddr(&destination, 172, 16, 1, 0);
-	  set_destination(&destination);
-      route = uaodv_rt_lookup_any(&destination);
-      if (route == NULL || route->is_bad) {
-        printf("Getting route from %d.%d.%d.%d to %d.%d.%d.%d\n", uip_ipaddr_to_quad(&uip_hostaddr), uip_ipaddr_to_quad(&destination));
-        uaodv_request_route_to(&destination);
-		//route = uaodv_rt_lookup_any(&destination); // NOTE: added this line and changed from if to while loop
-      }
-		if (route == NULL) {
-			printf("Route is null.\n");
-		} else if (route->is_bad) {
-			printf("Route is bad.\n");
-		}
-#endif
-	  if(!skip)
-      {
-        char buffer[UIP_APPDATA_SIZE];
-		int siz = TRAFFIC_TRANSMIT_PAYLOAD(buffer, UIP_APPDATA_SIZE);
-        printf("TRAFFIC: -> [");
-		uip_debug_ipaddr_print(&destination);
-		printf("]:%u, \"%s\" //after delay of %"PRIu32"\n",TRAFFIC_PORT, buffer, interval);
-		uip_udp_packet_sendto(udp_conn, buffer, siz, &destination, UIP_HTONS(TRAFFIC_PORT));
-      }
-      
-      interval = get_interval();
-// #ifdef TRAFFIC_SHRINK_FACTOR
-//       interval = interval >> TRAFFIC_CDF_SHRINK_FACTOR;
-// #endif
-	  
-	  printf("interval: %"PRIu32"\n", interval);
-      etimer_reset_with_new_interval(&et, interval);
+    if (ev == PROCESS_EVENT_TIMER && data == &et) {
+      serve_flows();
+    }
+#if TRAFFIC_STATS_PRINT_INTERVAL
+    if(ev == PROCESS_EVENT_TIMER && data == &et_stats) {
+      traffic_stats_print();
+      etimer_reset(&et_stats);
     }
 #endif
-
-// 	printf("end of loop: %u\n", previous_arrival_time);
   }
   PROCESS_END();
-  printf("TRAFFIC: process ended\n");
+  LOG_INFO("TRAFFIC: process ended\n");
 }
 
 void
@@ -538,4 +913,4 @@ void
 traffic_end()
 {
   process_exit(&traffic_process);
-}
\ No newline at end of file
+}
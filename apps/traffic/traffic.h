@@ -39,6 +39,10 @@
 #define CONTIKI_WITH_IPV4 1
 #endif
 
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "lib/prng.h"
+
 #define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
 #define UIP_UDP_BUF  ((struct uip_udp_hdr *)&uip_buf[uip_l2_l3_hdr_len])
 
@@ -54,6 +58,69 @@ int TRAFFIC_TRANSMIT_PAYLOAD(char* buffer, int max);
 extern const char *TRAFFIC_DESTINATIONS[TRAFFIC_DESTINATIONS_COUNT];
 #endif
 
+/**
+ * A traffic flow: a stream of UDP packets to a set of destinations, with
+ * inter-packet intervals drawn from its own distribution. Any number of
+ * flows can be active at the same time; they are served by a single
+ * process and a single timer ordered by next deadline.
+ *
+ * Initialize a flow with traffic_flow_init(), optionally override its
+ * port, payload size, payload callback or interval sampler, and activate
+ * it with traffic_flow_add(). The flow and its resolved address table
+ * must stay allocated while the flow is active.
+ */
+struct traffic_flow {
+  struct traffic_flow *next;
+  clock_time_t deadline;                 /**< Time of the next packet */
+  uint32_t interval;                     /**< Last sampled interval */
+  uint32_t (* get_interval)(struct traffic_flow *flow); /**< Interval sampler, in clock ticks */
+  int (* payload)(char *buffer, int max); /**< Fills the payload, returns its length */
+  const char **destinations;             /**< Destinations, as in TRAFFIC_DESTINATIONS */
+  uip_ipaddr_t *resolved;                /**< Room for destinations_count addresses */
+  uint16_t port;                         /**< Destination UDP port */
+  uint16_t payload_size;                 /**< Maximum payload passed to the callback */
+  uint8_t destinations_count;
+  uint8_t resolved_count;
+  uint16_t seq;                          /**< Number of packets sent */
+  uint8_t id;
+  struct prng prng;                      /**< Stream of the flow, seeded from its id */
+};
+
+/* Prepend a struct traffic_header to every packet, so that receivers can
+ * account for loss, reordering and latency (see traffic-stats.h) */
+#ifndef TRAFFIC_PAYLOAD_HEADER
+#define TRAFFIC_PAYLOAD_HEADER 1
+#endif
+
+/**
+ * Header of the packets of the traffic generator, when
+ * TRAFFIC_PAYLOAD_HEADER is enabled. It is written in network byte order
+ * in front of the payload filled by the flow's callback.
+ */
+struct traffic_header {
+  uint8_t flow;                          /**< Flow id at the origin */
+  uint16_t origin;                       /**< Last two bytes of the origin link address */
+  uint16_t seq;                          /**< Sequence number in the flow */
+  uint32_t timestamp;                    /**< TRAFFIC_TIMESTAMP() at the origin */
+};
+
+#define TRAFFIC_HEADER_MAGIC 0x54
+#define TRAFFIC_HEADER_LEN 10
+
+void traffic_flow_init(struct traffic_flow *flow, const char **destinations,
+                       uint8_t destinations_count, uip_ipaddr_t *resolved);
+void traffic_flow_add(struct traffic_flow *flow);
+void traffic_flow_remove(struct traffic_flow *flow);
+
+/**
+ * Apply a change of traffic_config (traffic-config.h) to the running
+ * generator. Called by traffic_config_set().
+ */
+void traffic_reconfigure(void);
+
+int traffic_transmit_hello(char* buffer, int max);
+uint32_t get_interval(struct traffic_flow *flow);
+
 void traffic_init();
 void traffic_end();
 
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026, Contiki contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         prng library. xoshiro128** by Blackman and Vigna: 128 bits of
+ *         state, a handful of shifts, rotations and additions per 32-bit
+ *         output, and statistically far better than the 16-bit rand() of
+ *         most C libraries. Each module keeps its own stream.
+ */
+
+#include "lib/prng.h"
+#include "lib/random.h"
+#include "net/linkaddr.h"
+
+/*---------------------------------------------------------------------------*/
+static uint32_t
+rotl(uint32_t x, int k)
+{
+  return (x << k) | (x >> (32 - k));
+}
+/*---------------------------------------------------------------------------*/
+/* splitmix32, used to expand a seed to a full, never all-zero, state */
+static uint32_t
+splitmix32(uint32_t *x)
+{
+  uint32_t z = (*x += 0x9e3779b9);
+  z = (z ^ (z >> 16)) * 0x85ebca6b;
+  z = (z ^ (z >> 13)) * 0xc2b2ae35;
+  return z ^ (z >> 16);
+}
+/*---------------------------------------------------------------------------*/
+void
+prng_seed(struct prng *p, uint32_t seed)
+{
+  int i;
+  for(i = 0; i < 4; i++) {
+    p->s[i] = splitmix32(&seed);
+  }
+  if((p->s[0] | p->s[1] | p->s[2] | p->s[3]) == 0) {
+    p->s[0] = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+prng_seed_lladdr(struct prng *p, uint8_t stream)
+{
+  uint32_t seed = stream;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    seed = seed * 31 + linkaddr_node_addr.u8[i];
+  }
+  if(stream != PRNG_STREAM_RANDOM) {
+    /* Platform entropy, if random_init() was given any */
+    seed ^= (uint32_t)random_rand() << 16;
+  }
+  p->stream = stream;
+  prng_seed(p, seed);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+prng_next32(struct prng *p)
+{
+  uint32_t result;
+  uint32_t t;
+
+  if((p->s[0] | p->s[1] | p->s[2] | p->s[3]) == 0) {
+    prng_seed_lladdr(p, p->stream);
+  }
+
+  result = rotl(p->s[1] * 5, 7) * 9;
+  t = p->s[1] << 9;
+  p->s[2] ^= p->s[0];
+  p->s[3] ^= p->s[1];
+  p->s[1] ^= p->s[2];
+  p->s[0] ^= p->s[3];
+  p->s[2] ^= t;
+  p->s[3] = rotl(p->s[3], 11);
+  return result;
+}
+/*---------------------------------------------------------------------------*/
+uint64_t
+prng_next64(struct prng *p)
+{
+  uint64_t high = prng_next32(p);
+  return (high << 32) | prng_next32(p);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+prng_bounded(struct prng *p, uint32_t range)
+{
+  uint64_t m = (uint64_t)prng_next32(p) * range;
+  uint32_t threshold;
+
+  if((uint32_t)m < range) {
+    /* 2^32 mod range: products below it would bias the result */
+    threshold = -range % range;
+    while((uint32_t)m < threshold) {
+      m = (uint64_t)prng_next32(p) * range;
+    }
+  }
+  return m >> 32;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+prng_bounded16(struct prng *p, uint16_t range)
+{
+  uint32_t m = (prng_next32(p) >> 16) * range;
+  uint16_t threshold;
+
+  if((uint16_t)m < range) {
+    threshold = (uint16_t)(-range) % range;
+    while((uint16_t)m < threshold) {
+      m = (prng_next32(p) >> 16) * range;
+    }
+  }
+  return m >> 16;
+}
+/*---------------------------------------------------------------------------*/
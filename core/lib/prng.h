@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026, Contiki contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Header file for the prng library: xoshiro128** pseudo-random
+ *         number generator with independent, per-module streams.
+ */
+
+#ifndef PRNG_H_
+#define PRNG_H_
+
+#include "contiki-conf.h"
+
+/* Stream identifiers, mixed into the seed of lazily seeded streams */
+#define PRNG_STREAM_RANDOM   0
+#define PRNG_STREAM_CSMA     1
+#define PRNG_STREAM_RPL      2
+#define PRNG_STREAM_TRAFFIC 16 /* + flow id */
+
+struct prng {
+  uint32_t s[4];
+  uint8_t stream;
+};
+
+/**
+ * \brief Declare a stream, seeded on first use from the link-layer address,
+ *        random_rand() and the stream identifier
+ * \param name Name of the stream variable
+ * \param id Stream identifier, e.g. PRNG_STREAM_CSMA
+ */
+#define PRNG(name, id) static struct prng name = { { 0, 0, 0, 0 }, id }
+
+/**
+ * \brief Seed a stream from a 32-bit value
+ * \param p Pointer to the stream
+ * \param seed Seed, any value is valid
+ */
+void prng_seed(struct prng *p, uint32_t seed);
+
+/**
+ * \brief Seed a stream from the link-layer address, random_rand() and
+ *        the stream identifier, so that nodes and streams differ
+ * \param p Pointer to the stream
+ * \param stream Stream identifier
+ */
+void prng_seed_lladdr(struct prng *p, uint8_t stream);
+
+/**
+ * \brief Next 32-bit pseudo-random number of a stream
+ */
+uint32_t prng_next32(struct prng *p);
+
+/**
+ * \brief Next 64-bit pseudo-random number of a stream
+ */
+uint64_t prng_next64(struct prng *p);
+
+/**
+ * \brief Unbiased pseudo-random number in [0, range), using a
+ *        multiply-shift with rejection of the (rare) biased products
+ * \param p Pointer to the stream
+ * \param range Exclusive upper bound, must be larger than 0
+ */
+uint32_t prng_bounded(struct prng *p, uint32_t range);
+
+/**
+ * \brief As prng_bounded(), using only 16x16-bit multiplications
+ */
+uint16_t prng_bounded16(struct prng *p, uint16_t range);
+
+#endif /* PRNG_H_ */
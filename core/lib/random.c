@@ -32,23 +32,25 @@
 
 
 #include "lib/random.h"
+#include "lib/prng.h"
 #include "sys/clock.h"
 
-#include <stdlib.h>
+/* Fixed, non-zero state until random_init() is called, like srand(1) */
+static struct prng random_prng = {
+  { 0x9e3779b9, 0x243f6a88, 0xb7e15162, 0x85a308d3 }, PRNG_STREAM_RANDOM
+};
 
 /*---------------------------------------------------------------------------*/
 void
 random_init(unsigned short seed)
 {
-  srand(seed);
+  prng_seed(&random_prng, seed);
 }
 /*---------------------------------------------------------------------------*/
 unsigned short
 random_rand(void)
 {
-/* In gcc int rand() uses RAND_MAX and long random() uses RANDOM_MAX=0x7FFFFFFF */
-/* RAND_MAX varies depending on the architecture */
-
-  return (unsigned short)rand();
+  /* The high bits of xoshiro128** are the strongest */
+  return (unsigned short)(prng_next32(&random_prng) >> 16);
 }
 /*---------------------------------------------------------------------------*/
@@ -45,8 +45,9 @@ void random_init(unsigned short seed);
  */
 unsigned short random_rand(void);
 
-/* In gcc int rand() uses RAND_MAX and long random() uses RANDOM_MAX */
-/* Since random_rand casts to unsigned short, we'll use this maxmimum */
+/* random_rand returns unsigned short, we'll use this maxmimum. The core
+ * implementation is backed by the 32-bit generator of lib/prng.h, which
+ * also provides independent streams and unbiased bounded draws. */
 #define RANDOM_RAND_MAX 65535U
 
 #endif /* RANDOM_H_ */
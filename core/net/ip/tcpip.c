@@ -108,9 +108,14 @@ static struct internal_state {
 enum {
   TCP_POLL,
   UDP_POLL,
-  PACKET_INPUT
+  PACKET_INPUT,
+  PACKET_INPUT_BATCH
 };
 
+/* The driver function delivering frames during tcpip_input_batch() */
+static int (* batch_input)(void);
+static int batch_count;
+
 /* Called on IP packet output. */
 #if NETSTACK_CONF_WITH_IPV6
 
@@ -515,16 +520,37 @@ eventhandler(process_event_t ev, process_data_t data)
   case PACKET_INPUT:
     packet_input();
     break;
+
+  case PACKET_INPUT_BATCH:
+    while(batch_count < TCPIP_INPUT_BATCH && batch_input()) {
+      batch_count++;
+    }
+    break;
   };
 }
 /*---------------------------------------------------------------------------*/
 void
 tcpip_input(void)
 {
-  process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
+  if(batch_input != NULL && PROCESS_CURRENT() == &tcpip_process) {
+    /* Part of a batch, we already run in the TCP/IP process */
+    packet_input();
+  } else {
+    process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
+  }
   uip_clear_buf();
 }
 /*---------------------------------------------------------------------------*/
+int
+tcpip_input_batch(int (* input)(void))
+{
+  batch_input = input;
+  batch_count = 0;
+  process_post_synch(&tcpip_process, PACKET_INPUT_BATCH, NULL);
+  batch_input = NULL;
+  return batch_count;
+}
+/*---------------------------------------------------------------------------*/
 #if NETSTACK_CONF_WITH_IPV6
 void
 tcpip_ipv6_output(void)
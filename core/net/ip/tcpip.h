@@ -88,6 +88,14 @@ typedef struct tcpip_uipstate uip_icmp6_appstate_t;
 #include "net/ip/uip.h"
 void tcpip_uipcall(void);
 
+/* Maximum number of frames delivered per invocation of the TCP/IP
+   process by tcpip_input_batch() */
+#ifdef TCPIP_CONF_INPUT_BATCH
+#define TCPIP_INPUT_BATCH TCPIP_CONF_INPUT_BATCH
+#else
+#define TCPIP_INPUT_BATCH 4
+#endif
+
 /**
  * \name TCP functions
  * @{
@@ -336,6 +344,23 @@ CCIF extern process_event_t tcpip_event;
  */
 CCIF void tcpip_input(void);
 
+/**
+ * \brief      Deliver several incoming frames to the TCP/IP stack
+ * \param input Function that passes the next received frame up the
+ *             network stack (to NETSTACK_RDC.input()), and returns
+ *             zero if there is none
+ * \return     The number of frames delivered
+ *
+ *             This function is called by radio drivers that buffer
+ *             several received frames. It calls input() up to
+ *             TCPIP_INPUT_BATCH times from within the TCP/IP process,
+ *             so that the packets handed to tcpip_input() are processed
+ *             without a process switch each. A driver should poll
+ *             itself again when the batch was full, so that other
+ *             processes run between batches.
+ */
+int tcpip_input_batch(int (* input)(void));
+
 /**
  * \brief Output packet to layer 2
  * The eventual parameter is the MAC address of the destination.
@@ -51,10 +51,12 @@ void
 uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
 {
 #if UIP_UDP
-  if(data != NULL && len <= (UIP_BUFSIZE - (UIP_LLH_LEN + UIP_IPUDPH_LEN))) {
+  if(data != NULL && len <= UIP_UDP_PACKET_APPDATA_SIZE) {
     uip_udp_conn = c;
     uip_slen = len;
-    memmove(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], data, len);
+    if(data != UIP_UDP_PACKET_APPDATA) {
+      memmove(UIP_UDP_PACKET_APPDATA, data, len);
+    }
     uip_process(UIP_UDP_SEND_CONN);
 
 #if UIP_IPV6_MULTICAST
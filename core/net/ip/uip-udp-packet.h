@@ -42,6 +42,15 @@
 
 #include "net/ip/uip.h"
 
+/**
+ * Where the payload of an outgoing UDP packet is placed in uip_buf, and
+ * the room available there. A payload built directly at
+ * UIP_UDP_PACKET_APPDATA and passed as data to uip_udp_packet_send() or
+ * uip_udp_packet_sendto() is sent without being copied.
+ */
+#define UIP_UDP_PACKET_APPDATA ((void *)&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
+#define UIP_UDP_PACKET_APPDATA_SIZE (UIP_BUFSIZE - (UIP_LLH_LEN + UIP_IPUDPH_LEN))
+
 void uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len);
 void uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
 			   const uip_ipaddr_t *toaddr, uint16_t toport);
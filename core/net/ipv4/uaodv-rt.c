@@ -38,25 +38,58 @@
  */
 
 
+#include <string.h>
+
 #include "net/ipv4/uaodv-rt.h"
 #include "contiki-net.h"
 
-#ifndef UAODV_NUM_RT_ENTRIES
-#define UAODV_NUM_RT_ENTRIES 8
-#endif
-
 /*
  * LRU (with respect to insertion time) list of route entries.
  */
 LIST(route_table);
 MEMB(route_mem, struct uaodv_rt_entry, UAODV_NUM_RT_ENTRIES);
 
+#if UAODV_RT_HASH_SIZE & (UAODV_RT_HASH_SIZE - 1)
+#error UAODV_RT_HASH_SIZE must be a power of two
+#endif
+
+/*
+ * The same entries, chained by destination address.
+ */
+static struct uaodv_rt_entry *buckets[UAODV_RT_HASH_SIZE];
+
+/* Expiry times are kept in full seconds: a 16-bit time would make a route
+   that idled for more than 2^15 seconds look fresh again. */
+#define NOW() clock_seconds()
+#define EXPIRED(e) ((long)(NOW() - (e)->expires) >= 0)
+
+/*---------------------------------------------------------------------------*/
+static struct uaodv_rt_entry **
+bucket(const uip_ipaddr_t *dest)
+{
+  /* Hosts differ mostly in the last two bytes of their address. */
+  return &buckets[(dest->u8[2] ^ dest->u8[3]) & (UAODV_RT_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(struct uaodv_rt_entry *e)
+{
+  struct uaodv_rt_entry **p;
+
+  for(p = bucket(&e->dest); *p != NULL; p = &(*p)->hash_next) {
+    if(*p == e) {
+      *p = e->hash_next;
+      return;
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 void
 uaodv_rt_init(void)
 {
   list_init(route_table);
   memb_init(&route_mem);
+  memset(buckets, 0, sizeof(buckets));
 }
 /*---------------------------------------------------------------------------*/
 struct uaodv_rt_entry *
@@ -64,6 +97,7 @@ uaodv_rt_add(uip_ipaddr_t *dest, uip_ipaddr_t *nexthop,
 	     unsigned hop_count, const uint32_t *seqno)
 {
   struct uaodv_rt_entry *e;
+  struct uaodv_rt_entry **b;
 
   /* Avoid inserting duplicate entries. */
   e = uaodv_rt_lookup_any(dest);
@@ -74,14 +108,20 @@ uaodv_rt_add(uip_ipaddr_t *dest, uip_ipaddr_t *nexthop,
     e = memb_alloc(&route_mem);
     if(e == NULL) {
       e = list_chop(route_table); /* Remove oldest entry. */
+      hash_remove(e);
     }
+    uip_ipaddr_copy(&e->dest, dest);
+    e->nprecursors = 0;
+    b = bucket(dest);
+    e->hash_next = *b;
+    *b = e;
   }
 
-  uip_ipaddr_copy(&e->dest, dest);
   uip_ipaddr_copy(&e->nexthop, nexthop);
   e->hop_count = hop_count;
   e->hseqno = uip_ntohl(*seqno);
   e->is_bad = 0;
+  e->expires = NOW() + UAODV_ACTIVE_ROUTE_TIMEOUT;
 
   /* New entry goes first. */
   list_push(route_table, e);
@@ -94,12 +134,21 @@ uaodv_rt_lookup_any(uip_ipaddr_t *dest)
 {
   struct uaodv_rt_entry *e;
 
-  for(e = list_head(route_table); e != NULL; e = e->next) {
+  for(e = *bucket(dest); e != NULL; e = e->hash_next) {
     if(uip_ipaddr_cmp(dest, &e->dest)) {
-      return e;
+      break;
+    }
+  }
+  if(e != NULL && EXPIRED(e)) {
+    /* An expired route is kept invalid for a while, as its sequence
+       number is still needed. */
+    if(e->is_bad) {
+      uaodv_rt_remove(e);
+      return NULL;
     }
+    uaodv_rt_invalidate(e);
   }
-  return NULL;
+  return e;
 }
 
 struct uaodv_rt_entry *
@@ -113,18 +162,44 @@ uaodv_rt_lookup(uip_ipaddr_t *dest)
   return e;
 }
 /*---------------------------------------------------------------------------*/
-#if 0
 void
 uaodv_rt_remove(struct uaodv_rt_entry *e)
 {
+  hash_remove(e);
   list_remove(route_table, e);
   memb_free(&route_mem, e);
 }
-#endif
+/*---------------------------------------------------------------------------*/
+void
+uaodv_rt_invalidate(struct uaodv_rt_entry *e)
+{
+  e->is_bad = 1;
+  e->expires = NOW() + UAODV_DELETE_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+void
+uaodv_rt_add_precursor(struct uaodv_rt_entry *e, uip_ipaddr_t *addr)
+{
+  int i;
 
+  for(i = 0; i < e->nprecursors && i < UAODV_NUM_PRECURSORS; i++) {
+    if(uip_ipaddr_cmp(&e->precursors[i], addr)) {
+      return;
+    }
+  }
+  if(e->nprecursors < UAODV_NUM_PRECURSORS) {
+    uip_ipaddr_copy(&e->precursors[e->nprecursors], addr);
+  }
+  if(e->nprecursors <= UAODV_NUM_PRECURSORS) {
+    e->nprecursors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
 void
 uaodv_rt_lru(struct uaodv_rt_entry *e)
 {
+  /* A route in use stays active. */
+  e->expires = NOW() + UAODV_ACTIVE_ROUTE_TIMEOUT;
   if(e != list_head(route_table)) {
     list_remove(route_table, e);
     list_push(route_table, e);
@@ -143,4 +218,5 @@ uaodv_rt_flush_all(void)
     else
       break;
   }
+  memset(buckets, 0, sizeof(buckets));
 }
@@ -42,21 +42,51 @@
 
 #include "contiki-net.h"
 
+#ifndef UAODV_NUM_RT_ENTRIES
+#define UAODV_NUM_RT_ENTRIES 8
+#endif
+
+/* Number of hash buckets of the route table, a power of two. */
+#ifndef UAODV_RT_HASH_SIZE
+#define UAODV_RT_HASH_SIZE 8
+#endif
+
+/* Number of precursors remembered per route. */
+#ifndef UAODV_NUM_PRECURSORS
+#define UAODV_NUM_PRECURSORS 2
+#endif
+
+/* Lifetime of an unused route, and time an invalid route is kept to
+   remember its sequence number, in seconds. */
+#ifndef UAODV_ACTIVE_ROUTE_TIMEOUT
+#define UAODV_ACTIVE_ROUTE_TIMEOUT 30
+#endif
+#ifndef UAODV_DELETE_PERIOD
+#define UAODV_DELETE_PERIOD (5 * UAODV_ACTIVE_ROUTE_TIMEOUT)
+#endif
+
 struct uaodv_rt_entry {
   struct uaodv_rt_entry *next;
+  struct uaodv_rt_entry *hash_next;
   uip_ipaddr_t dest;
   uip_ipaddr_t nexthop;
+  uip_ipaddr_t precursors[UAODV_NUM_PRECURSORS];
   uint32_t hseqno;			/* In host byte order! */
+  unsigned long expires;		/* In clock_seconds(). */
+  uint8_t nprecursors;			/* Above UAODV_NUM_PRECURSORS on overflow. */
   uint8_t hop_count;
   uint8_t is_bad;			/* Only one bit is used. */
 };
 
+void uaodv_rt_init(void);
 struct uaodv_rt_entry *
 uaodv_rt_add(uip_ipaddr_t *dest, uip_ipaddr_t *nexthop,
 	     unsigned hop_count, const uint32_t *seqno);
 struct uaodv_rt_entry *uaodv_rt_lookup_any(uip_ipaddr_t *dest);
 struct uaodv_rt_entry *uaodv_rt_lookup(uip_ipaddr_t *dest);
 void uaodv_rt_remove(struct uaodv_rt_entry *e);
+void uaodv_rt_invalidate(struct uaodv_rt_entry *e);
+void uaodv_rt_add_precursor(struct uaodv_rt_entry *e, uip_ipaddr_t *addr);
 void uaodv_rt_lru(struct uaodv_rt_entry *e);
 void uaodv_rt_flush_all(void);
 
@@ -39,10 +39,14 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "contiki.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 #include "net/ipv4/uaodv-def.h"
 #include "net/ipv4/uaodv-rt.h"
+#include "net/ipv4/uaodv.h"
 
 #define NDEBUG
 #include "lib/assert.h"
@@ -52,10 +56,29 @@
 #define RSSI_THRESHOLD -39	/* accept -39 ... xx */
 #endif
 
-/* This implementation never expires routes!!! */
-#define MY_ROUTE_TIMEOUT 0x7fffffff /* Should be 0xffffffff! */
+/* Route lifetime advertised in RREPs, in milliseconds. */
+#define MY_ROUTE_TIMEOUT (UAODV_ACTIVE_ROUTE_TIMEOUT * 1000UL)
 #define MY_NET_DIAMETER  20
 
+/* RREQ retries, and time to wait for the first RREP (doubled on every
+   retry). */
+#define RREQ_RETRIES       2
+#define NET_TRAVERSAL_TIME (2 * CLOCK_SECOND)
+
+/* Number of route discoveries in progress at the same time. */
+#ifndef UAODV_NUM_DISCOVERIES
+#define UAODV_NUM_DISCOVERIES 4
+#endif
+
+/* Packets held back by uaodv_sendto() until their route is discovered,
+   and their maximum payload size. */
+#ifndef UAODV_NUM_PENDING
+#define UAODV_NUM_PENDING 4
+#endif
+#ifndef UAODV_PENDING_SIZE
+#define UAODV_PENDING_SIZE 64
+#endif
+
 PROCESS(uaodv_process, "uAODV");
 
 static struct uip_udp_conn *bcastconn, *unicastconn;
@@ -99,6 +122,72 @@ fwc_add(const uip_ipaddr_t *orig, const uint32_t *id)
   uip_ipaddr_copy(&fwcache[n].orig, orig);
 }
 
+struct pending {
+  struct pending *next;
+  struct uip_udp_conn *conn;
+  uint16_t port;		/* In network byte order! */
+  uint16_t len;
+  uint8_t data[UAODV_PENDING_SIZE];
+};
+
+MEMB(pending_mem, struct pending, UAODV_NUM_PENDING);
+
+/*
+ * Route discoveries in progress. A discovery sends RREQs for its
+ * destination until a route shows up or the retries are exhausted. The
+ * packets queued for the destination are then sent in order, or dropped
+ * if no route was found.
+ */
+static struct discovery {
+  LIST_STRUCT(packets);
+  uip_ipaddr_t dest;
+  struct timer timer;		/* Until the next RREQ. */
+  uint8_t tries;
+  uint8_t found;
+  uint8_t used;
+} discoveries[UAODV_NUM_DISCOVERIES];
+
+static struct etimer discovery_timer;
+
+/* Find the discovery for a destination, or a free one if dest is NULL. */
+static struct discovery *
+discovery_find(const uip_ipaddr_t *dest)
+{
+  struct discovery *d;
+
+  for(d = discoveries; d < &discoveries[UAODV_NUM_DISCOVERIES]; d++) {
+    if(dest == NULL ? !d->used
+       : d->used && uip_ipaddr_cmp(&d->dest, dest)) {
+      return d;
+    }
+  }
+  return NULL;
+}
+
+static void
+discovery_end(struct discovery *d)
+{
+  struct pending *p;
+
+  while((p = list_pop(d->packets)) != NULL) {
+    memb_free(&pending_mem, p);
+  }
+  d->used = 0;
+}
+
+/* Packets queued for a destination can go as soon as a route to it is
+   added, whether it was learnt from our RREQ or from another node's. */
+static void
+discovery_route_added(const uip_ipaddr_t *dest)
+{
+  struct discovery *d = discovery_find(dest);
+
+  if(d != NULL && !d->found) {
+    d->found = 1;
+    process_post(&uaodv_process, PROCESS_EVENT_MSG, NULL);
+  }
+}
+
 #ifdef NDEBUG
 #define PRINTF(...) do {} while (0)
 #define print_debug(...) do{}while(0)
@@ -223,8 +312,20 @@ send_rrep(uip_ipaddr_t *dest, uip_ipaddr_t *nexthop, uip_ipaddr_t *orig,
   sendto(nexthop, rm, sizeof(struct uaodv_msg_rrep));
 }
 /*---------------------------------------------------------------------------*/
+/* Send a RERR to the precursors of a route: none if it has none, unicast
+   if there is only one (RFC 3561, 6.11). Unknown routes get a broadcast. */
+static void
+send_rerr_to_precursors(struct uaodv_rt_entry *rt, void *rm)
+{
+  if(rt == NULL || rt->nprecursors > 1) {
+    uip_udp_packet_send(bcastconn, rm, sizeof(struct uaodv_msg_rerr));
+  } else if(rt->nprecursors == 1) {
+    sendto(&rt->precursors[0], rm, sizeof(struct uaodv_msg_rerr));
+  }
+}
+/*---------------------------------------------------------------------------*/
 static void
-send_rerr(uip_ipaddr_t *addr, uint32_t *seqno)
+send_rerr(uip_ipaddr_t *addr, uint32_t *seqno, struct uaodv_rt_entry *rt)
 {
   struct uaodv_msg_rerr *rm = (struct uaodv_msg_rerr *)uip_appdata;
   
@@ -240,7 +341,7 @@ send_rerr(uip_ipaddr_t *addr, uint32_t *seqno)
   else
     rm->flags = 0;
 
-  uip_udp_packet_send(bcastconn, rm, sizeof(struct uaodv_msg_rerr));
+  send_rerr_to_precursors(rt, rm);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -313,6 +414,7 @@ handle_incoming_rreq(void)
     print_debug("Inserting1\n");
     rt = uaodv_rt_add(&rm->orig_addr, uip_udp_sender(),
 		      rm->hop_count, &rm->orig_seqno);
+    discovery_route_added(&rm->orig_addr);
   }
     
   /* Check if it is for our address or a fresh route. */
@@ -335,6 +437,8 @@ handle_incoming_rreq(void)
     uip_ipaddr_copy(&dest_addr, &rm->dest_addr);
     uip_ipaddr_copy(&orig_addr, &rm->orig_addr);
     net_seqno = uip_htonl(fw->hseqno);
+    uaodv_rt_add_precursor(fw, &rt->nexthop);
+    uaodv_rt_add_precursor(rt, &fw->nexthop);
     send_rrep(&dest_addr, &rt->nexthop, &orig_addr, &net_seqno,
 	      fw->hop_count + 1);
   } else if(uip_ipaddr_cmp(&rm->dest_addr, &uip_hostaddr)) {
@@ -375,7 +479,7 @@ static void
 handle_incoming_rrep(void)
 {
   struct uaodv_msg_rrep *rm = (struct uaodv_msg_rrep *)uip_appdata;
-  struct uaodv_rt_entry *rt;
+  struct uaodv_rt_entry *rt, *fw;
 
   /* Useless HELLO message? */
   if(uip_ipaddr_cmp(&BUF->destipaddr, &uip_broadcast_addr)) {
@@ -416,6 +520,7 @@ handle_incoming_rrep(void)
     print_debug("Inserting3\n");
     rt = uaodv_rt_add(&rm->dest_addr, uip_udp_sender(),
 		      rm->hop_count, &rm->dest_seqno);
+    discovery_route_added(&rm->dest_addr);
 #ifdef CC2420_RADIO
     /* This link is ok since he is unicasting back to us! */
     cc2420_recv_ok(uip_udp_sender());
@@ -436,6 +541,7 @@ handle_incoming_rrep(void)
       sendto(uip_udp_sender(), ack, sizeof(*ack));
     }
   } else {
+    fw = rt;
     rt = uaodv_rt_lookup(&rm->orig_addr);
 
     if(rt == NULL) {
@@ -451,6 +557,11 @@ handle_incoming_rrep(void)
 
     rm->hop_count++;
 
+    if(fw != NULL) {
+      uaodv_rt_add_precursor(fw, &rt->nexthop);
+      uaodv_rt_add_precursor(rt, &fw->nexthop);
+    }
+
     print_debug("Fwd RREP to %d.%d.%d.%d\n", uip_ipaddr_to_quad(&rt->nexthop));
 
     sendto(&rt->nexthop, rm, sizeof(struct uaodv_msg_rrep));
@@ -477,13 +588,13 @@ handle_incoming_rerr(void)
   if(rt != NULL && uip_ipaddr_cmp(&rt->nexthop, uip_udp_sender())) {
     if((rm->flags & UAODV_RERR_UNKNOWN) || rm->unreach[0].seqno == 0
        || SCMP32(rt->hseqno, uip_ntohl(rm->unreach[0].seqno)) <= 0) {
-      rt->is_bad = 1;
+      uaodv_rt_invalidate(rt);
       if(rm->flags & UAODV_RERR_UNKNOWN) {
 	rm->flags &= ~UAODV_RERR_UNKNOWN;
 	rm->unreach[0].seqno = uip_htonl(rt->hseqno);
       }
       print_debug("RERR rebroadcast\n");
-      uip_udp_packet_send(bcastconn, rm, sizeof(struct uaodv_msg_rerr));
+      send_rerr_to_precursors(rt, rm);
     }
   }
 }
@@ -512,7 +623,6 @@ handle_incoming_packet(void)
 /*---------------------------------------------------------------------------*/
 static enum {
   COMMAND_NONE,
-  COMMAND_SEND_RREQ,
   COMMAND_SEND_RERR,
 } command;
 
@@ -527,7 +637,7 @@ uaodv_bad_dest(uip_ipaddr_t *dest)
   if(rt == NULL)
     bad_seqno = 0;		/* Or flag this in RERR? */
   else {
-    rt->is_bad = 1;
+    uaodv_rt_invalidate(rt);
     bad_seqno = uip_htonl(rt->hseqno);
   }
 
@@ -536,13 +646,13 @@ uaodv_bad_dest(uip_ipaddr_t *dest)
   process_post(&uaodv_process, PROCESS_EVENT_MSG, NULL);
 }
 
-static uip_ipaddr_t rreq_addr;
 static struct timer next_time;
 
 struct uaodv_rt_entry *
 uaodv_request_route_to(uip_ipaddr_t *host)
 {
   struct uaodv_rt_entry *route = uaodv_rt_lookup(host);
+  struct discovery *d;
 
   if(route != NULL) {
     uaodv_rt_lru(route);
@@ -550,23 +660,159 @@ uaodv_request_route_to(uip_ipaddr_t *host)
   }
 
   /*
-   * Broadcast protocols must be rate-limited!
+   * Only one discovery per destination, later requests just wait for it.
    */
-  if(!timer_expired(&next_time)) {
+  if(discovery_find(host) != NULL) {
     return NULL;
   }
-
-  if(command != COMMAND_NONE) {
+  d = discovery_find(NULL);
+  if(d == NULL) {
     return NULL;
   }
 
-  uip_ipaddr_copy(&rreq_addr, host);
-  command = COMMAND_SEND_RREQ;
+  LIST_STRUCT_INIT(d, packets);
+  uip_ipaddr_copy(&d->dest, host);
+  d->used = 1;
+  d->found = 0;
+  d->tries = 0;
+  timer_set(&d->timer, 0);
   process_post(&uaodv_process, PROCESS_EVENT_MSG, NULL);
-  timer_set(&next_time, CLOCK_SECOND/8); /* Max 10/s per RFC3561. */
   return NULL;
 }
+/*---------------------------------------------------------------------------*/
+/* Send the RREQ of the first discovery that is due, if broadcasts are not
+   rate-limited. */
+static void
+discovery_send(void)
+{
+  struct discovery *d;
+
+  /*
+   * Broadcast protocols must be rate-limited!
+   */
+  if(!timer_expired(&next_time)) {
+    return;
+  }
+
+  for(d = discoveries; d < &discoveries[UAODV_NUM_DISCOVERIES]; d++) {
+    if(!d->used || d->found || !timer_expired(&d->timer)) {
+      continue;
+    }
+    if(uaodv_rt_lookup(&d->dest) != NULL) {
+      /* Learnt from another node's RREQ or RREP meanwhile. */
+      d->found = 1;
+      continue;
+    }
+    if(d->tries > RREQ_RETRIES) {
+      print_debug("no route to %d.%d.%d.%d\n", uip_ipaddr_to_quad(&d->dest));
+      discovery_end(d);
+      continue;
+    }
+    send_rreq(&d->dest);
+    timer_set(&d->timer, NET_TRAVERSAL_TIME << d->tries);
+    d->tries++;
+    timer_set(&next_time, CLOCK_SECOND/8); /* Max 10/s per RFC3561. */
+    return;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Send the next queued packet of a discovery that found its route.
+   Returns 1 if a packet was sent. */
+static int
+discovery_drain(void)
+{
+  struct discovery *d;
+  struct pending *p;
+  struct uaodv_rt_entry *route;
+
+  for(d = discoveries; d < &discoveries[UAODV_NUM_DISCOVERIES]; d++) {
+    if(!d->used || !d->found) {
+      continue;
+    }
+    p = list_pop(d->packets);
+    route = p != NULL ? uaodv_rt_lookup(&d->dest) : NULL;
+    if(route == NULL) {
+      /* Done, or the route broke again. */
+      if(p != NULL) {
+        memb_free(&pending_mem, p);
+      }
+      discovery_end(d);
+      continue;
+    }
+    uaodv_rt_lru(route);
+    uip_udp_packet_sendto(p->conn, p->data, p->len, &d->dest, p->port);
+    memb_free(&pending_mem, p);
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+uaodv_sendto(struct uip_udp_conn *c, const void *data, int len,
+             uip_ipaddr_t *toaddr, uint16_t toport)
+{
+  struct discovery *d;
+  struct pending *p;
+
+  /* Packets already queued for the destination go first. */
+  d = discovery_find(toaddr);
+  if(d == NULL && uaodv_request_route_to(toaddr) != NULL) {
+    uip_udp_packet_sendto(c, data, len, toaddr, toport);
+    return UAODV_SENT;
+  }
 
+  if(d == NULL) {
+    d = discovery_find(toaddr);
+  }
+  if(d == NULL || len > UAODV_PENDING_SIZE) {
+    return UAODV_DROPPED;
+  }
+  p = memb_alloc(&pending_mem);
+  if(p == NULL) {
+    return UAODV_DROPPED;
+  }
+  p->conn = c;
+  p->port = toport;
+  p->len = len;
+  memcpy(p->data, data, len);
+  list_add(d->packets, p);
+  return UAODV_QUEUED;
+}
+/*---------------------------------------------------------------------------*/
+/* Wake up when the next RREQ or queued packet is due */
+static void
+discovery_schedule(void)
+{
+  struct discovery *d;
+  clock_time_t wait = 0;
+  clock_time_t remaining;
+  int pending = 0;
+
+  for(d = discoveries; d < &discoveries[UAODV_NUM_DISCOVERIES]; d++) {
+    if(!d->used) {
+      continue;
+    }
+    if(d->found) {
+      /* Queued packets are unicast, they are not rate-limited. */
+      etimer_set(&discovery_timer, 0);
+      return;
+    }
+    remaining = timer_expired(&d->timer) ? 0 : timer_remaining(&d->timer);
+    if(!pending || remaining < wait) {
+      wait = remaining;
+    }
+    pending = 1;
+  }
+  if(!pending) {
+    etimer_stop(&discovery_timer);
+    return;
+  }
+  if(!timer_expired(&next_time) && timer_remaining(&next_time) > wait) {
+    wait = timer_remaining(&next_time);
+  }
+  etimer_set(&discovery_timer, wait);
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(uaodv_process, ev, data)
 {
   PROCESS_EXITHANDLER(goto exit);
@@ -575,6 +821,8 @@ PROCESS_THREAD(uaodv_process, ev, data)
 
   printf("uaodv_process starting %lu\n", (unsigned long) my_hseqno);
 
+  uaodv_rt_init();
+
   bcastconn = udp_broadcast_new(UIP_HTONS(UAODV_UDPPORT), NULL);
   unicastconn = udp_broadcast_new(UIP_HTONS(UAODV_UDPPORT), NULL);
   
@@ -587,24 +835,28 @@ PROCESS_THREAD(uaodv_process, ev, data)
 	continue;
       }
       if(uip_poll()) {
-	if(command == COMMAND_SEND_RREQ) {
-	  if(uaodv_rt_lookup(&rreq_addr) == NULL)
-	    send_rreq(&rreq_addr);
-	} else if (command == COMMAND_SEND_RERR) {
-	  send_rerr(&bad_dest, &bad_seqno);
+	/* One message per poll, the others wait for the next one. */
+	if(command == COMMAND_SEND_RERR) {
+	  send_rerr(&bad_dest, &bad_seqno, uaodv_rt_lookup_any(&bad_dest));
+	  command = COMMAND_NONE;
+	} else if(!discovery_drain()) {
+	  discovery_send();
 	}
-	command = COMMAND_NONE;
+	discovery_schedule();
 	continue;
       }
     }
 
-    if(ev == PROCESS_EVENT_MSG) {
+    if(ev == PROCESS_EVENT_MSG
+       || (ev == PROCESS_EVENT_TIMER && data == &discovery_timer)) {
       tcpip_poll_udp(bcastconn);
     }
   }
 
  exit:
   command = COMMAND_NONE;
+  memset(discoveries, 0, sizeof(discoveries));
+  memb_init(&pending_mem);
   uaodv_rt_flush_all();
   uip_udp_remove(bcastconn);
   bcastconn = NULL;
@@ -48,4 +48,18 @@ PROCESS_NAME(uaodv_process);
 struct uaodv_rt_entry * uaodv_request_route_to(uip_ipaddr_t *host);
 void uaodv_bad_dest(uip_ipaddr_t *);
 
+/* Return values of uaodv_sendto() */
+#define UAODV_SENT     1
+#define UAODV_QUEUED   0
+#define UAODV_DROPPED -1
+
+/*
+ * Send a UDP packet like uip_udp_packet_sendto(), or hold it back while
+ * the route to toaddr is being discovered. Held packets are sent in
+ * order once the route is found, and dropped when the discovery fails.
+ * The connection must stay open until then.
+ */
+int uaodv_sendto(struct uip_udp_conn *c, const void *data, int len,
+                 uip_ipaddr_t *toaddr, uint16_t toport);
+
 #endif /* UAODV_H_ */
@@ -135,7 +135,7 @@ void uip_log(char *msg);
  *  @{
  */
 
-/* NOTE: In the multiple-reassembly context there is only room for the header / first fragment */
+/* The buffer an uncompressed header is written to, uip_buf when receiving */
 #define SICSLOWPAN_IP_BUF(buf)   ((struct uip_ip_hdr *)buf)
 #define SICSLOWPAN_UDP_BUF(buf)  ((struct uip_udp_hdr *)&buf[UIP_IPH_LEN])
 
@@ -164,6 +164,17 @@ void uip_log(char *msg);
 #define COMPRESSION_THRESHOLD 0
 #endif
 
+/** \brief Number of compressed IPHC headers remembered for reuse, through
+    the SICSLOWPAN_CONF_IPHC_CACHE option. Packets with the same IPv6
+    header (payload length aside), UDP ports and link-layer destination
+    as a remembered one get its encoding copied instead of recomputed,
+    with the UDP checksum patched in. */
+#ifdef SICSLOWPAN_CONF_IPHC_CACHE
+#define SICSLOWPAN_IPHC_CACHE SICSLOWPAN_CONF_IPHC_CACHE
+#else
+#define SICSLOWPAN_IPHC_CACHE 0
+#endif
+
 /** \brief Fixed size of a frame header. This value is
  * used in case framer returns an error or if SICSLOWPAN_USE_FIXED_HDRLEN
  * is defined.
@@ -231,9 +242,10 @@ static uint16_t my_tag;
 #endif
 
 /* REASS_CONTEXTS corresponds to the number of simultaneous
- * reassemblies that can be made. NOTE: the first buffer for each
- * reassembly is stored in the context since it can be larger than the
- * rest of the fragments due to header compression.
+ * reassemblies that can be made. A context only holds the bookkeeping
+ * of a reassembly, all fragments (including the uncompressed first
+ * one) are stored in the shared fragment buffers, so contexts are
+ * cheap and can be added without reserving a full datagram each.
  **/
 #ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
 #define SICSLOWPAN_REASS_CONTEXTS SICSLOWPAN_CONF_REASS_CONTEXTS
@@ -248,8 +260,22 @@ static uint16_t my_tag;
 #define SICSLOWPAN_FRAGMENT_SIZE 110
 #endif
 
-/* Assuming that the worst growth for uncompression is 38 bytes */
-#define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
+/* Fragment forwarding: a router that is not the destination of a
+ * fragmented datagram relays its fragments to the next hop as they
+ * arrive instead of reassembling it first. Only the first fragment is
+ * decompressed, to find the next hop. */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARD
+#define SICSLOWPAN_FRAG_FORWARD (SICSLOWPAN_CONF_FRAG_FORWARD && UIP_CONF_ROUTER)
+#else
+#define SICSLOWPAN_FRAG_FORWARD 0
+#endif
+
+/* Number of datagrams that can be forwarded simultaneously */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES
+#else
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES 2
+#endif
 
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
@@ -265,12 +291,6 @@ struct sicslowpan_frag_info {
   uint16_t reassembled_len;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
-
-  /** Fragment size of first fragment */
-  uint16_t first_frag_len;
-  /** First fragment - needs a larger buffer since the size is uncompressed size
-   and we need to know total size to know when we have received last fragment. */
-  uint8_t first_frag[SICSLOWPAN_FIRST_FRAGMENT_SIZE];
 };
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
@@ -278,15 +298,67 @@ static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 struct sicslowpan_frag_buf {
   /* the index of the frag_info */
   uint8_t index;
-  /* Fragment offset */
-  uint8_t offset;
   /* Length of this fragment (if zero this buffer is not allocated) */
   uint8_t len;
+  /* Offset of the data in the IP packet, in bytes */
+  uint16_t offset;
   uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
 };
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
 
+#if SICSLOWPAN_FRAG_FORWARD
+/* A datagram being forwarded fragment by fragment */
+struct sicslowpan_frag_fwd {
+  /** The link-layer sender and tag of the incoming fragments */
+  linkaddr_t sender;
+  uint16_t tag;
+  /** The next hop and the tag of the outgoing fragments */
+  linkaddr_t nexthop;
+  uint16_t out_tag;
+  /** Datagram size (if zero this entry is not allocated) */
+  uint16_t len;
+  /** Bytes of the datagram forwarded so far */
+  uint16_t forwarded_len;
+  struct timer timer;
+};
+
+static struct sicslowpan_frag_fwd frag_fwd[SICSLOWPAN_FRAG_FORWARD_ENTRIES];
+#endif /* SICSLOWPAN_FRAG_FORWARD */
+
+/*---------------------------------------------------------------------------*/
+/* The reassembly context a (sender, tag) pair is looked up from first */
+static uint8_t
+frag_context_hash(const linkaddr_t *sender, uint16_t tag)
+{
+  uint16_t h;
+  int i;
+
+  h = tag;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = h * 31 + sender->u8[i];
+  }
+  return h % SICSLOWPAN_REASS_CONTEXTS;
+}
+/*---------------------------------------------------------------------------*/
+static int
+find_context(const linkaddr_t *sender, uint16_t tag)
+{
+  int i, n;
+
+  /* Contexts are freed in any order, so a miss probes all of them */
+  i = frag_context_hash(sender, tag);
+  for(n = 0; n < SICSLOWPAN_REASS_CONTEXTS; n++) {
+    if(frag_info[i].len > 0 && frag_info[i].tag == tag &&
+       linkaddr_cmp(&frag_info[i].sender, sender)) {
+      return i;
+    }
+    if(++i == SICSLOWPAN_REASS_CONTEXTS) {
+      i = 0;
+    }
+  }
+  return -1;
+}
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
@@ -319,36 +391,52 @@ timeout_fragments(int not_context)
   return count;
 }
 /*---------------------------------------------------------------------------*/
+/* Copy len bytes of data at the given byte offset of the IP packet into
+   the shared fragment buffers, splitting it if it does not fit in one */
 static int
-store_fragment(uint8_t index, uint8_t offset)
+store_fragment(uint8_t index, uint16_t offset, const uint8_t *data, uint16_t len)
 {
   int i;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
+  uint16_t stored;
+
+  stored = 0;
+  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS && stored < len; i++) {
     if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = packetbuf_datalen() - packetbuf_hdr_len;
+      /* copy over the data into the fragment buffer and store offset and len */
+      frag_buf[i].offset = offset + stored;
+      frag_buf[i].len = MIN(len - stored, SICSLOWPAN_FRAGMENT_SIZE);
       frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len,
-             packetbuf_datalen() - packetbuf_hdr_len);
+      memcpy(frag_buf[i].data, data + stored, frag_buf[i].len);
+      stored += frag_buf[i].len;
 
       PRINTF("Fragsize: %d\n", frag_buf[i].len);
-      /* return the length of the stored fragment */
-      return frag_buf[i].len;
     }
   }
-  /* failed */
-  return -1;
+  if(stored < len) {
+    /* failed - release the part that was stored */
+    while(i-- > 0) {
+      if(frag_buf[i].len > 0 && frag_buf[i].index == index &&
+         frag_buf[i].offset >= offset && frag_buf[i].offset < offset + len) {
+        frag_buf[i].len = 0;
+      }
+    }
+    return -1;
+  }
+  /* return the length of the stored fragment */
+  return len;
 }
 /*---------------------------------------------------------------------------*/
 /* add a new fragment to the buffer */
 static int8_t
 add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 {
-  int i;
+  const linkaddr_t *sender;
+  int i, n;
   int len;
   int8_t found = -1;
 
+  sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+
   if(offset == 0) {
     /* This is a first fragment - check if we can add this */
     for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
@@ -356,12 +444,23 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
       if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
 	clear_fragments(i);
       }
+    }
 
+    /* A repeated first fragment restarts its reassembly */
+    found = find_context(sender, tag);
+    if(found >= 0) {
+      clear_fragments(found);
+    } else {
       /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
+      i = frag_context_hash(sender, tag);
+      for(n = 0; n < SICSLOWPAN_REASS_CONTEXTS; n++) {
+        if(frag_info[i].len == 0) {
+          found = i;
+          break;
+        }
+        if(++i == SICSLOWPAN_REASS_CONTEXTS) {
+          i = 0;
+        }
       }
     }
 
@@ -373,23 +472,15 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
     /* Found a free fragment info to store data in */
     frag_info[found].len = frag_size;
     frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    linkaddr_copy(&frag_info[found].sender, sender);
     timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-    /* first fragment can not be stored immediately but is moved into
-       the buffer while uncompressing */
+    /* first fragment can not be stored immediately but is stored once
+       uncompressed */
     return found;
   }
 
   /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
-    }
-  }
+  found = find_context(sender, tag);
 
   if(found < 0) {
     /* no entry found for storing the new fragment */
@@ -397,22 +488,45 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
     return -1;
   }
 
-  /* i is the index of the reassembly context */
-  len = store_fragment(i, offset);
-  if(len < 0 && timeout_fragments(i) > 0) {
-    len = store_fragment(i, offset);
+  /* found is the index of the reassembly context */
+  len = store_fragment(found, (uint16_t)(offset << 3),
+                       packetbuf_ptr + packetbuf_hdr_len,
+                       packetbuf_datalen() - packetbuf_hdr_len);
+  if(len < 0 && timeout_fragments(found) > 0) {
+    len = store_fragment(found, (uint16_t)(offset << 3),
+                         packetbuf_ptr + packetbuf_hdr_len,
+                         packetbuf_datalen() - packetbuf_hdr_len);
   }
   if(len > 0) {
-    frag_info[i].reassembled_len += len;
-    return i;
+    frag_info[found].reassembled_len += len;
+    return found;
   } else {
     /* should we also clear all fragments since we failed to store
        this fragment? */
-    PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
+    PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[found].tag);
     return -1;
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Store the first fragment, uncompressed in uip_buf, in the context */
+static int
+add_first_fragment(int context, uint16_t len)
+{
+  int stored;
+
+  stored = store_fragment(context, 0, (uint8_t *)UIP_IP_BUF, len);
+  if(stored < 0 && timeout_fragments(context) > 0) {
+    stored = store_fragment(context, 0, (uint8_t *)UIP_IP_BUF, len);
+  }
+  if(stored < 0) {
+    PRINTF("*** Failed to store first fragment - tag: %d\n", frag_info[context].tag);
+    clear_fragments(context);
+    return -1;
+  }
+  frag_info[context].reassembled_len = len;
+  return context;
+}
+/*---------------------------------------------------------------------------*/
 /* Copy all the fragments that are associated with a specific context
    into uip */
 static void
@@ -420,13 +534,10 @@ copy_frags2uip(int context)
 {
   int i;
 
-  /* Copy from the fragment context info buffer first */
-  memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)frag_info[context].first_frag,
-	 frag_info[context].first_frag_len);
   for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    /* And also copy all matching fragments */
+    /* Copy all matching fragments, the first one included */
     if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
-      memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(frag_buf[i].offset << 3),
+      memcpy((uint8_t *)UIP_IP_BUF + frag_buf[i].offset,
 	     (uint8_t *)frag_buf[i].data, frag_buf[i].len);
     }
   }
@@ -630,6 +741,89 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
   PRINTF("\n");
 }
 
+#if SICSLOWPAN_IPHC_CACHE
+/*--------------------------------------------------------------------*/
+/** \name IPHC encoding cache
+ * @{                                                                 */
+/*--------------------------------------------------------------------*/
+/* Longest IPHC encoding: dispatch, CID, flow label, next header, hop
+   limit, both addresses inline and LOWPAN_UDP with both ports inline */
+#define IPHC_CACHE_HDR_LEN (2 + 1 + 4 + 1 + 1 + 16 + 16 + 1 + 4 + 2)
+
+struct sicslowpan_iphc_cache {
+  /** The IPv6 header the encoding was computed from */
+  uint8_t ip[UIP_IPH_LEN];
+  /** UDP ports, if the UDP header is compressed */
+  uint16_t srcport;
+  uint16_t destport;
+  linkaddr_t link_destaddr;
+  /** Length of the encoding (if zero this entry is not used) */
+  uint8_t len;
+  uint8_t uncomp_hdr_len;
+  /** Position of the UDP checksum in the encoding, zero if none */
+  uint8_t chksum;
+  uint8_t hdr[IPHC_CACHE_HDR_LEN];
+};
+
+static struct sicslowpan_iphc_cache iphc_cache[SICSLOWPAN_IPHC_CACHE];
+/** The entry replaced next */
+static uint8_t iphc_cache_next;
+
+/* The payload length is elided by IPHC and is not part of the key */
+#define IPHC_CACHE_LEN_POS 4
+#define IPHC_CACHE_PROTO_POS 6
+
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_iphc_cache *
+iphc_cache_lookup(const linkaddr_t *link_destaddr)
+{
+  struct sicslowpan_iphc_cache *e;
+
+  for(e = iphc_cache; e < &iphc_cache[SICSLOWPAN_IPHC_CACHE]; e++) {
+    /* The addresses tell flows apart, compare them first */
+    if(e->len > 0 &&
+       memcmp(&e->ip[IPHC_CACHE_PROTO_POS],
+              (uint8_t *)UIP_IP_BUF + IPHC_CACHE_PROTO_POS,
+              UIP_IPH_LEN - IPHC_CACHE_PROTO_POS) == 0 &&
+       memcmp(e->ip, UIP_IP_BUF, IPHC_CACHE_LEN_POS) == 0 &&
+       linkaddr_cmp(&e->link_destaddr, link_destaddr) &&
+       (e->chksum == 0 ||
+        (e->srcport == UIP_UDP_BUF->srcport &&
+         e->destport == UIP_UDP_BUF->destport))) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/* Remember the encoding just written to packetbuf */
+static void
+iphc_cache_store(const linkaddr_t *link_destaddr, uint8_t chksum)
+{
+  struct sicslowpan_iphc_cache *e;
+
+  if(packetbuf_hdr_len > IPHC_CACHE_HDR_LEN) {
+    return;
+  }
+  e = &iphc_cache[iphc_cache_next];
+  if(++iphc_cache_next == SICSLOWPAN_IPHC_CACHE) {
+    iphc_cache_next = 0;
+  }
+
+  memcpy(e->ip, UIP_IP_BUF, UIP_IPH_LEN);
+  if(chksum > 0) {
+    e->srcport = UIP_UDP_BUF->srcport;
+    e->destport = UIP_UDP_BUF->destport;
+  }
+  linkaddr_copy(&e->link_destaddr, link_destaddr);
+  e->len = packetbuf_hdr_len;
+  e->uncomp_hdr_len = uncomp_hdr_len;
+  e->chksum = chksum;
+  memcpy(e->hdr, packetbuf_ptr, packetbuf_hdr_len);
+}
+/** @} */
+#endif /* SICSLOWPAN_IPHC_CACHE */
+
 /*--------------------------------------------------------------------*/
 /**
  * \brief Compress IP/UDP header
@@ -669,6 +863,10 @@ static void
 compress_hdr_iphc(linkaddr_t *link_destaddr)
 {
   uint8_t tmp, iphc0, iphc1;
+#if SICSLOWPAN_IPHC_CACHE
+  struct sicslowpan_iphc_cache *e;
+  uint8_t chksum = 0;
+#endif /* SICSLOWPAN_IPHC_CACHE */
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -680,6 +878,19 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
   }
 #endif
 
+#if SICSLOWPAN_IPHC_CACHE
+  e = iphc_cache_lookup(link_destaddr);
+  if(e != NULL) {
+    memcpy(packetbuf_ptr, e->hdr, e->len);
+    if(e->chksum > 0) {
+      memcpy(packetbuf_ptr + e->chksum, &UIP_UDP_BUF->udpchksum, 2);
+    }
+    packetbuf_hdr_len = e->len;
+    uncomp_hdr_len = e->uncomp_hdr_len;
+    return;
+  }
+#endif /* SICSLOWPAN_IPHC_CACHE */
+
   hc06_ptr = packetbuf_ptr + 2;
   /*
    * As we copy some bit-length fields, in the IPHC encoding bytes,
@@ -920,6 +1131,9 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     }
     /* always inline the checksum  */
     if(1) {
+#if SICSLOWPAN_IPHC_CACHE
+      chksum = hc06_ptr - packetbuf_ptr;
+#endif /* SICSLOWPAN_IPHC_CACHE */
       memcpy(hc06_ptr, &UIP_UDP_BUF->udpchksum, 2);
       hc06_ptr += 2;
     }
@@ -932,6 +1146,9 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
   PACKETBUF_IPHC_BUF[1] = iphc1;
 
   packetbuf_hdr_len = hc06_ptr - packetbuf_ptr;
+#if SICSLOWPAN_IPHC_CACHE
+  iphc_cache_store(link_destaddr, chksum);
+#endif /* SICSLOWPAN_IPHC_CACHE */
   return;
 }
 
@@ -1487,6 +1704,219 @@ output(const uip_lladdr_t *localdest)
   return 1;
 }
 
+#if SICSLOWPAN_FRAG_FORWARD
+/*--------------------------------------------------------------------*/
+/* The room left for 6lowpan in a frame to dest, as computed by output() */
+static int
+frag_forward_max_payload(const linkaddr_t *dest)
+{
+  int framer_hdrlen;
+
+#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  framer_hdrlen = NETSTACK_FRAMER.length();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+  }
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+#endif /* USE_FRAMER_HDRLEN */
+
+  return MAC_MAX_PAYLOAD - framer_hdrlen;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the link-layer next hop of the datagram whose first
+ * fragment is uncompressed in uip_buf, if it can be forwarded without
+ * reassembly.
+ * \return the next hop, or NULL if the datagram is for us or needs to
+ * be processed by the IP layer first
+ */
+static const uip_lladdr_t *
+forward_nexthop(void)
+{
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  const uip_lladdr_t *lladdr;
+
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     UIP_IP_BUF->ttl <= 1 ||
+     UIP_IP_BUF->proto == UIP_PROTO_ROUTING) {
+    return NULL;
+  }
+
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else if((route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    nexthop = uip_ds6_route_nexthop(route);
+  } else {
+    nexthop = uip_ds6_defrt_choose();
+  }
+  if(nexthop == NULL) {
+    return NULL;
+  }
+
+  lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
+  if(lladdr == NULL ||
+     linkaddr_cmp((const linkaddr_t *)lladdr, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+    return NULL;
+  }
+  return lladdr;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forward a first fragment, uncompressed in uip_buf, to the next
+ * hop of its datagram and remember where the next fragments go.
+ * \param tag the tag of the incoming fragment
+ * \param frag_size the size of the datagram
+ * \param len the uncompressed length of the first fragment
+ * \return 1 if the fragment was forwarded, 0 if the datagram must be
+ * reassembled
+ */
+static int
+forward_first_fragment(uint16_t tag, uint16_t frag_size, uint16_t len)
+{
+  struct sicslowpan_frag_fwd *f;
+  const uip_lladdr_t *lladdr;
+  linkaddr_t sender;
+  linkaddr_t dest;
+  int payload_len;
+  int i;
+
+  lladdr = forward_nexthop();
+  if(lladdr == NULL) {
+    return 0;
+  }
+  linkaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  linkaddr_copy(&dest, (const linkaddr_t *)lladdr);
+
+  /* A repeated first fragment reuses its entry */
+  f = NULL;
+  for(i = 0; i < SICSLOWPAN_FRAG_FORWARD_ENTRIES; i++) {
+    if(frag_fwd[i].len > 0 && timer_expired(&frag_fwd[i].timer)) {
+      frag_fwd[i].len = 0;
+    }
+    if(frag_fwd[i].len > 0 && frag_fwd[i].tag == tag &&
+       linkaddr_cmp(&frag_fwd[i].sender, &sender)) {
+      f = &frag_fwd[i];
+    }
+  }
+  for(i = 0; f == NULL && i < SICSLOWPAN_FRAG_FORWARD_ENTRIES; i++) {
+    if(frag_fwd[i].len == 0) {
+      f = &frag_fwd[i];
+    }
+  }
+  if(f == NULL) {
+    PRINTFI("sicslowpan forward: no free entry, reassembling tag %d\n", tag);
+    return 0;
+  }
+
+  /* Compress the header again for the next link */
+  UIP_IP_BUF->ttl--;
+  uncomp_hdr_len = 0;
+  packetbuf_hdr_len = 0;
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_iphc(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
+  payload_len = (int)len - (int)uncomp_hdr_len;
+  if(payload_len < 0 ||
+     SICSLOWPAN_FRAG1_HDR_LEN + packetbuf_hdr_len + payload_len >
+     frag_forward_max_payload(&dest)) {
+    /* The fragment does not fit on the next link, reassemble it */
+    PRINTFI("sicslowpan forward: first fragment too large, reassembling tag %d\n", tag);
+    UIP_IP_BUF->ttl++;
+    packetbuf_clear();
+    packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &sender);
+    return 0;
+  }
+
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | frag_size));
+  f->out_tag = my_tag++;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, f->out_tag);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  memcpy(packetbuf_ptr + packetbuf_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, payload_len);
+  packetbuf_set_datalen(payload_len + packetbuf_hdr_len);
+
+  linkaddr_copy(&f->sender, &sender);
+  f->tag = tag;
+  linkaddr_copy(&f->nexthop, &dest);
+  f->len = frag_size;
+  f->forwarded_len = len;
+  timer_set(&f->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  PRINTFI("sicslowpan forward: FRAG1 tag %d -> %d\n", tag, f->out_tag);
+  send_packet(&dest);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forward a subsequent fragment in packetbuf if its first
+ * fragment was forwarded.
+ * \return 1 if the fragment was forwarded, 0 otherwise
+ */
+static int
+forward_fragment(uint16_t tag)
+{
+  struct sicslowpan_frag_fwd *f;
+  uint8_t *data;
+  uint16_t datalen;
+  int i;
+
+  f = NULL;
+  for(i = 0; i < SICSLOWPAN_FRAG_FORWARD_ENTRIES; i++) {
+    if(frag_fwd[i].len > 0 && frag_fwd[i].tag == tag &&
+       linkaddr_cmp(&frag_fwd[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      f = &frag_fwd[i];
+      break;
+    }
+  }
+  if(f == NULL) {
+    return 0;
+  }
+  if(timer_expired(&f->timer)) {
+    /* Too late, the datagram can not be completed anymore */
+    f->len = 0;
+    return 1;
+  }
+
+  /* The fragment is sent as is, under the tag of the next link */
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, f->out_tag);
+  data = packetbuf_dataptr();
+  datalen = packetbuf_datalen();
+  packetbuf_clear();
+  memmove(packetbuf_dataptr(), data, datalen);
+  packetbuf_set_datalen(datalen);
+  if(datalen > frag_forward_max_payload(&f->nexthop)) {
+    /* Fragments are not fragmented again, the datagram is lost */
+    PRINTFI("sicslowpan forward: fragment too large for the next hop\n");
+    f->len = 0;
+    return 1;
+  }
+
+  f->forwarded_len += datalen - packetbuf_hdr_len;
+  if(f->forwarded_len >= f->len) {
+    /* All fragments went through */
+    f->len = 0;
+  }
+
+  PRINTFI("sicslowpan forward: FRAGN tag %d -> %d\n", tag, f->out_tag);
+  send_packet(&f->nexthop);
+  return 1;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARD */
+
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *
@@ -1555,15 +1985,8 @@ input(void)
       first_fragment = 1;
       is_fragment = 1;
 
-      /* Add the fragment to the fragmentation context */
-      frag_context = add_fragment(frag_tag, frag_size, frag_offset);
-
-      if(frag_context == -1) {
-        return;
-      }
-
-      buffer = frag_info[frag_context].first_frag;
-
+      /* The first fragment is uncompressed in uip_buf and only added
+         to a fragmentation context once we know it is not forwarded */
       break;
     case SICSLOWPAN_DISPATCH_FRAGN:
       /*
@@ -1583,6 +2006,12 @@ input(void)
       PRINTFI("last_fragment?: packetbuf_payload_len %d frag_size %d\n",
               packetbuf_datalen() - packetbuf_hdr_len, frag_size);
 
+#if SICSLOWPAN_FRAG_FORWARD
+      if(forward_fragment(frag_tag)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARD */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
@@ -1678,8 +2107,18 @@ input(void)
   if(frag_size > 0) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
-      frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+      uint16_t first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+#if SICSLOWPAN_FRAG_FORWARD
+      if(forward_first_fragment(frag_tag, frag_size, first_frag_len)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARD */
+      /* Add the fragment to the fragmentation context */
+      frag_context = add_fragment(frag_tag, frag_size, frag_offset);
+      if(frag_context == -1 ||
+         add_first_fragment(frag_context, first_frag_len) == -1) {
+        return;
+      }
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
@@ -75,6 +75,16 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_INDEX
+/* Host routes are hashed on their address, the other routes are on
+   the prefix list ordered by decreasing length. Instead of keeping
+   routelist in most recently used order, each route records the
+   lookup sequence number of its last use. */
+static uip_ds6_route_t *route_hash[UIP_DS6_ROUTE_HASH_SIZE];
+static uip_ds6_route_t *prefix_routes;
+static uint16_t lookup_seq;
+#endif /* UIP_DS6_ROUTE_INDEX */
+
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -119,6 +129,108 @@ assert_nbr_routes_list_sane(void)
 }
 #endif /* DEBUG != DEBUG_NONE */
 /*---------------------------------------------------------------------------*/
+#if (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_INDEX
+static uip_ds6_route_t **
+index_head(const uip_ipaddr_t *addr, uint8_t length)
+{
+  uint16_t h;
+  int i;
+
+  if(length != 128) {
+    return &prefix_routes;
+  }
+  h = 0;
+  for(i = 0; i < sizeof(uip_ipaddr_t); i++) {
+    h = (h * 33) ^ addr->u8[i];
+  }
+  return &route_hash[h & (UIP_DS6_ROUTE_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **p;
+
+  p = index_head(&r->ipaddr, r->length);
+  /* The first matching prefix must be the longest one */
+  while(*p != NULL && (*p)->length > r->length) {
+    p = &(*p)->index_next;
+  }
+  r->index_next = *p;
+  *p = r;
+  r->last_used = lookup_seq;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **p;
+
+  for(p = index_head(&r->ipaddr, r->length); *p != NULL;
+      p = &(*p)->index_next) {
+    if(*p == r) {
+      *p = r->index_next;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+index_lookup(uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+
+  for(r = *index_head(addr, 128); r != NULL; r = r->index_next) {
+    if(uip_ipaddr_cmp(addr, &r->ipaddr)) {
+      return r;
+    }
+  }
+  for(r = prefix_routes; r != NULL; r = r->index_next) {
+    if(uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Ages are differences of 16-bit sequence numbers. Every 0x4000 lookups,
+   those above 0x8000 are clamped so that none can wrap around and make a
+   long idle route look recently used. */
+static void
+index_used(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t *q;
+
+  if((++lookup_seq & 0x3fff) == 0) {
+    for(q = list_head(routelist); q != NULL; q = list_item_next(q)) {
+      if((uint16_t)(lookup_seq - q->last_used) > 0x8000) {
+        q->last_used = lookup_seq - 0x8000;
+      }
+    }
+  }
+  r->last_used = lookup_seq;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+static uip_ds6_route_t *
+index_least_recently_used(void)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *oldest;
+
+  oldest = NULL;
+  for(r = list_head(routelist); r != NULL; r = list_item_next(r)) {
+    if(oldest == NULL ||
+       (uint16_t)(lookup_seq - r->last_used) >
+       (uint16_t)(lookup_seq - oldest->last_used)) {
+      oldest = r;
+    }
+  }
+  return oldest;
+}
+#endif /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
+#endif /* (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_INDEX */
+/*---------------------------------------------------------------------------*/
 #if UIP_DS6_NOTIFICATIONS
 static void
 call_route_callback(int event, uip_ipaddr_t *route,
@@ -162,6 +274,10 @@ uip_ds6_route_init(void)
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_INDEX
+  memset(route_hash, 0, sizeof(route_hash));
+  prefix_routes = NULL;
+#endif /* UIP_DS6_ROUTE_INDEX */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -254,15 +370,23 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_INDEX
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_INDEX */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
 
+#if UIP_DS6_ROUTE_INDEX
+  found_route = index_lookup(addr);
+  if(found_route != NULL) {
+    index_used(found_route);
+  }
+#else /* UIP_DS6_ROUTE_INDEX */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -278,6 +402,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_INDEX */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -289,6 +414,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_INDEX
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -298,6 +424,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_INDEX */
 
   return found_route;
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -353,9 +480,13 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
       uip_ds6_route_t *oldest;
       oldest = NULL;
 #if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+#if UIP_DS6_ROUTE_INDEX
+      oldest = index_least_recently_used();
+#else /* UIP_DS6_ROUTE_INDEX */
       /* Removing the oldest route entry from the route table. The
          least recently used route is the first route on the list. */
       oldest = list_tail(routelist);
+#endif /* UIP_DS6_ROUTE_INDEX */
 #endif
       if(oldest == NULL) {
         return NULL;
@@ -436,6 +567,9 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_INDEX
+  index_add(r);
+#endif /* UIP_DS6_ROUTE_INDEX */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -479,6 +613,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_INDEX
+    index_rm(route);
+#endif /* UIP_DS6_ROUTE_INDEX */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -88,6 +88,22 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Index the routing table: host routes (/128) are kept in a hash
+   table and shorter prefixes on a list ordered by decreasing length,
+   so that lookups do not scan the whole table */
+#ifdef UIP_DS6_ROUTE_CONF_INDEX
+#define UIP_DS6_ROUTE_INDEX UIP_DS6_ROUTE_CONF_INDEX
+#else /* UIP_DS6_ROUTE_CONF_INDEX */
+#define UIP_DS6_ROUTE_INDEX 0
+#endif /* UIP_DS6_ROUTE_CONF_INDEX */
+
+/* Number of host route hash buckets, a power of two */
+#ifdef UIP_DS6_ROUTE_CONF_HASH_SIZE
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_DS6_ROUTE_CONF_HASH_SIZE
+#else /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+#define UIP_DS6_ROUTE_HASH_SIZE 16
+#endif /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -157,6 +173,12 @@ typedef struct uip_ds6_route {
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
 #endif
+#if UIP_DS6_ROUTE_INDEX
+  /* Next route in the same hash bucket, or on the prefix list */
+  struct uip_ds6_route *index_next;
+  /* Lookup sequence number of the last use, for LRU replacement */
+  uint16_t last_used;
+#endif /* UIP_DS6_ROUTE_INDEX */
   uint8_t length;
 } uip_ds6_route_t;
 
@@ -189,6 +189,22 @@ link_stats_input_callback(const linkaddr_t *lladdr)
       (int32_t)packet_rssi * EWMA_ALPHA) / EWMA_SCALE;
 }
 /*---------------------------------------------------------------------------*/
+#if MAC_WITH_STATS
+/* Returns the neighbor's MAC counters, NULL if it has no link statistics.
+ * The neighbor is not added here, as this could evict entries of other
+ * modules from the shared table: link_stats_packet_sent() adds it, but
+ * only after mac_stats_sent() has run. The first attempt to a new
+ * neighbor is therefore counted in the totals only. */
+struct mac_stats_counters *
+link_stats_mac_counters(const linkaddr_t *lladdr)
+{
+  struct link_stats *stats;
+
+  stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+  return stats != NULL ? &stats->mac : NULL;
+}
+#endif /* MAC_WITH_STATS */
+/*---------------------------------------------------------------------------*/
 /* Periodic timer called every FRESHNESS_HALF_LIFE minutes */
 static void
 periodic(void *ptr)
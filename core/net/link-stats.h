@@ -34,6 +34,7 @@
 #define LINK_STATS_H_
 
 #include "core/net/linkaddr.h"
+#include "net/mac/mac.h"
 
 /* ETX fixed point divisor. 128 is the value used by RPL (RFC 6551 and RFC 6719) */
 #ifdef LINK_STATS_CONF_ETX_DIVISOR
@@ -48,6 +49,9 @@ struct link_stats {
   int16_t rssi;               /* RSSI (received signal strength) */
   uint8_t freshness;          /* Freshness of the statistics */
   clock_time_t last_tx_time;  /* Last Tx timestamp */
+#if MAC_WITH_STATS
+  struct mac_stats_counters mac; /* MAC counters, see mac.h */
+#endif /* MAC_WITH_STATS */
 };
 
 /* Returns the neighbor's link statistics */
@@ -55,6 +59,12 @@ const struct link_stats *link_stats_from_lladdr(const linkaddr_t *lladdr);
 /* Are the statistics fresh? */
 int link_stats_is_fresh(const struct link_stats *stats);
 
+#if MAC_WITH_STATS
+/* Returns the neighbor's MAC counters, NULL if it has no link statistics
+ * yet: the first attempt to a new neighbor is not counted per neighbor */
+struct mac_stats_counters *link_stats_mac_counters(const linkaddr_t *lladdr);
+#endif /* MAC_WITH_STATS */
+
 /* Initializes link-stats module */
 void link_stats_init(void);
 /* Packet sent callback. Updates statistics for transmissions on a given link */
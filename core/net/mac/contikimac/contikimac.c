@@ -676,6 +676,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 #endif
       if(NETSTACK_RADIO.channel_clear() == 0) {
         collisions++;
+        MAC_STATS_CCA_FAILED(mac_stats_current);
         off();
         break;
       }
@@ -706,6 +707,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
   watchdog_periodic();
   t0 = RTIMER_NOW();
+  MAC_STATS_TX(mac_stats_current);
   for(strobes = 0, collisions = 0;
       got_strobe_ack == 0 && collisions == 0 &&
       RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + STROBE_TIME); strobes++) {
@@ -781,6 +783,12 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
   off();
 
+  MAC_STATS_RADIO_ON(mac_stats_current, (rtimer_clock_t)(RTIMER_NOW() - t0));
+  if(got_strobe_ack) {
+    /* Time to the rendezvous with the receiver */
+    MAC_STATS_ACK(mac_stats_current, (rtimer_clock_t)(RTIMER_NOW() - t0));
+  }
+
   PRINTF("contikimac: send (strobes=%u, len=%u, %s, %s), done\n", strobes,
          packetbuf_totlen(),
          got_strobe_ack ? "ack" : "no ack",
@@ -863,16 +871,16 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     return;
   }
 
-  /* Create and secure frames in advance */
+  /* Create and secure frames in advance. The last frame is created when
+     sent, as more packets may be queued behind it by then (e.g. while
+     waiting for the phase of the receiver) and its frame pending bit
+     must then be set. */
   curr = buf_list;
-  do {
-    next = list_item_next(curr);
+  while((next = list_item_next(curr)) != NULL) {
     queuebuf_to_packetbuf(curr->buf);
     if(!packetbuf_attr(PACKETBUF_ATTR_IS_CREATED_AND_SECURED)) {
       /* create and secure this frame */
-      if(next != NULL) {
-        packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
-      }
+      packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
 #if !NETSTACK_CONF_BRIDGE_MODE
       /* If NETSTACK_CONF_BRIDGE_MODE is set, assume PACKETBUF_ADDR_SENDER is already set. */
       packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
@@ -888,7 +896,7 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
       queuebuf_update_from_packetbuf(curr->buf);
     }
     curr = next;
-  } while(next != NULL);
+  }
 
   /* The receiver needs to be awoken before we send */
   is_receiver_awake = 0;
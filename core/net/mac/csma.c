@@ -45,6 +45,7 @@
 #include "sys/clock.h"
 
 #include "lib/random.h"
+#include "lib/prng.h"
 
 #include "net/netstack.h"
 
@@ -93,6 +94,15 @@
 #define CSMA_MAX_MAX_FRAME_RETRIES 7
 #endif
 
+/* Hand the packets queued to a neighbor to the RDC as one train, with the
+   frame pending bit set on all but the last, and back off only between
+   trains rather than after every packet */
+#ifdef CSMA_CONF_WITH_BURST
+#define CSMA_WITH_BURST CSMA_CONF_WITH_BURST
+#else
+#define CSMA_WITH_BURST 0
+#endif
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
@@ -129,9 +139,19 @@ MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
 MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
 LIST(neighbor_list);
+/* Own pseudo-random stream for the backoff */
+PRNG(csma_prng, PRNG_STREAM_CSMA);
+
+#if CSMA_WITH_BURST
+/* The neighbor whose train is with the RDC, and whether it needs a next
+   train once the RDC is done */
+static struct neighbor_queue *train_neighbor;
+static uint8_t train_reschedule;
+#endif /* CSMA_WITH_BURST */
 
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
+static void schedule_transmission(struct neighbor_queue *n);
 /*---------------------------------------------------------------------------*/
 static struct neighbor_queue *
 neighbor_queue_from_addr(const linkaddr_t *addr)
@@ -163,6 +183,25 @@ backoff_period(void)
   return time;
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_WITH_BURST
+static void
+mark_train(struct neighbor_queue *n)
+{
+  struct rdc_buf_list *q;
+
+  if(linkaddr_cmp(&n->addr, &linkaddr_null)) {
+    /* Broadcasts are not acknowledged, receivers cannot follow a train */
+    return;
+  }
+  /* Frames the RDC already created keep their header as is */
+  for(q = list_head(n->queued_packet_list); q != NULL; q = list_item_next(q)) {
+    if(!queuebuf_attr(q->buf, PACKETBUF_ATTR_IS_CREATED_AND_SECURED)) {
+      queuebuf_set_attr(q->buf, PACKETBUF_ATTR_PENDING, list_item_next(q) != NULL);
+    }
+  }
+}
+#endif /* CSMA_WITH_BURST */
+/*---------------------------------------------------------------------------*/
 static void
 transmit_packet_list(void *ptr)
 {
@@ -172,8 +211,20 @@ transmit_packet_list(void *ptr)
     if(q != NULL) {
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
           list_length(n->queued_packet_list));
+#if CSMA_WITH_BURST
+      mark_train(n);
+      train_neighbor = n;
+      train_reschedule = 0;
+#endif /* CSMA_WITH_BURST */
       /* Send packets in the neighbor's list */
       NETSTACK_RDC.send_list(packet_sent, n, q);
+#if CSMA_WITH_BURST
+      /* The neighbor is gone if the whole train went through */
+      if(train_neighbor != NULL && train_reschedule) {
+        schedule_transmission(train_neighbor);
+      }
+      train_neighbor = NULL;
+#endif /* CSMA_WITH_BURST */
     }
   }
 }
@@ -190,7 +241,7 @@ schedule_transmission(struct neighbor_queue *n)
   delay = ((1 << backoff_exponent) - 1) * backoff_period();
   if(delay > 0) {
     /* Pick a time for next transmission */
-    delay = random_rand() % delay;
+    delay = prng_bounded16(&csma_prng, MIN(delay, 0xffff));
   }
 
   PRINTF("csma: scheduling transmission in %u ticks, NB=%u, BE=%u\n",
@@ -199,6 +250,19 @@ schedule_transmission(struct neighbor_queue *n)
 }
 /*---------------------------------------------------------------------------*/
 static void
+reschedule_transmission(struct neighbor_queue *n)
+{
+#if CSMA_WITH_BURST
+  if(n == train_neighbor) {
+    /* Wait for the end of the train */
+    train_reschedule = 1;
+    return;
+  }
+#endif /* CSMA_WITH_BURST */
+  schedule_transmission(n);
+}
+/*---------------------------------------------------------------------------*/
+static void
 free_packet(struct neighbor_queue *n, struct rdc_buf_list *p, int status)
 {
   if(p != NULL) {
@@ -215,12 +279,17 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p, int status)
       n->transmissions = 0;
       n->collisions = CSMA_MIN_BE;
       /* Schedule next transmissions */
-      schedule_transmission(n);
+      reschedule_transmission(n);
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
       list_remove(neighbor_list, n);
       memb_free(&neighbor_memb, n);
+#if CSMA_WITH_BURST
+      if(n == train_neighbor) {
+        train_neighbor = NULL;
+      }
+#endif /* CSMA_WITH_BURST */
     }
   }
 }
@@ -259,7 +328,7 @@ tx_done(int status, struct rdc_buf_list *q, struct neighbor_queue *n)
 static void
 rexmit(struct rdc_buf_list *q, struct neighbor_queue *n)
 {
-  schedule_transmission(n);
+  reschedule_transmission(n);
   /* This is needed to correctly attribute energy that we spent
      transmitting this packet. */
   queuebuf_update_attr_from_packetbuf(q->buf);
@@ -326,6 +395,8 @@ packet_sent(void *ptr, int status, int num_transmissions)
     return;
   }
 
+  MAC_STATS_SENT(mac_stats_current, status, num_transmissions);
+
   /* Find out what packet this callback refers to */
   for(q = list_head(n->queued_packet_list);
       q != NULL; q = list_item_next(q)) {
@@ -383,6 +454,7 @@ send_packet(mac_callback_t sent, void *ptr)
     seqno++;
   }
   packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, seqno++);
+  MAC_STATS_ENQUEUED();
 
   /* Look for the neighbor entry */
   n = neighbor_queue_from_addr(addr);
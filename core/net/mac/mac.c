@@ -31,6 +31,11 @@
  */
 
 #include "net/mac/mac.h"
+#if MAC_WITH_STATS
+#include "net/packetbuf.h"
+#include "net/link-stats.h"
+#include <string.h>
+#endif /* MAC_WITH_STATS */
 
 #define DEBUG 0
 #if DEBUG
@@ -65,3 +70,63 @@ mac_call_sent_callback(mac_callback_t sent, void *ptr, int status, int num_tx)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if MAC_WITH_STATS
+struct mac_stats mac_stats_current;
+struct mac_stats_counters mac_stats_total;
+/*---------------------------------------------------------------------------*/
+void
+mac_stats_enqueued(void)
+{
+  /* 0 stands for a packet already sent once */
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_ENQUEUE_TIME, (uint16_t)clock_time() | 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+count(struct mac_stats_counters *c, const struct mac_stats *stats,
+      uint16_t queue_delay, uint8_t first, uint8_t retries)
+{
+  c->queue_delay += queue_delay;
+  c->packets += first;
+  c->retries += retries;
+  c->cca_failures += stats->cca_failures;
+  c->ack_latency += stats->ack_latency;
+  c->acks += stats->acks;
+  c->radio_on += stats->radio_on;
+}
+/*---------------------------------------------------------------------------*/
+void
+mac_stats_sent(struct mac_stats *stats, int status, int num_tx)
+{
+  uint16_t enqueue_time;
+  uint16_t queue_delay = 0;
+  uint8_t first = 0;
+  uint8_t retries = 0;
+
+  if(status == MAC_TX_DEFERRED) {
+    /* The attempt goes on */
+    return;
+  }
+
+  if(stats->first_tx != 0) {
+    enqueue_time = packetbuf_attr(PACKETBUF_ATTR_MAC_ENQUEUE_TIME);
+    if(enqueue_time != 0) {
+      /* First Tx of the packet. The MAC keeps the cleared stamp along with
+         the packet if it tries again. */
+      queue_delay = stats->first_tx - enqueue_time;
+      first = 1;
+      packetbuf_set_attr(PACKETBUF_ATTR_MAC_ENQUEUE_TIME, 0);
+    }
+    retries = num_tx - first;
+  }
+
+  count(&mac_stats_total, stats, queue_delay, first, retries);
+  if(!packetbuf_holds_broadcast()) {
+    struct mac_stats_counters *c = link_stats_mac_counters(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    if(c != NULL) {
+      count(c, stats, queue_delay, first, retries);
+    }
+  }
+  memset(stats, 0, sizeof(*stats));
+}
+/*---------------------------------------------------------------------------*/
+#endif /* MAC_WITH_STATS */
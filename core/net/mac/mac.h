@@ -48,6 +48,64 @@ typedef void (* mac_callback_t)(void *ptr, int status, int transmissions);
 
 void mac_call_sent_callback(mac_callback_t sent, void *ptr, int status, int num_tx);
 
+/* Collect per-neighbor MAC statistics: queueing delay, CCA failures,
+ * retries, ACK latency and radio-on time. Off by default, the hooks then
+ * compile out. */
+#ifdef MAC_CONF_WITH_STATS
+#define MAC_WITH_STATS MAC_CONF_WITH_STATS
+#else /* MAC_CONF_WITH_STATS */
+#define MAC_WITH_STATS 0
+#endif /* MAC_CONF_WITH_STATS */
+
+#if MAC_WITH_STATS
+#include "sys/clock.h"
+
+/* Statistics of one transmission attempt, accumulated by the MAC and RDC
+ * until the attempt is reported with MAC_STATS_SENT() */
+struct mac_stats {
+  uint32_t radio_on;          /* Radio-on time, in rtimer ticks */
+  uint32_t ack_latency;       /* Delay until the ACK, in rtimer ticks */
+  uint16_t first_tx;          /* clock_time() of the first Tx, 0 if none */
+  uint8_t cca_failures;
+  uint8_t acks;
+};
+
+/* Counters, per neighbor in link-stats and in total in mac_stats_total */
+struct mac_stats_counters {
+  uint32_t queue_delay;       /* Sum of enqueue-to-first-Tx delays, in clock ticks */
+  uint32_t ack_latency;       /* Sum of ACK latencies, in rtimer ticks */
+  uint32_t radio_on;          /* Radio-on time of Tx, in rtimer ticks */
+  uint16_t packets;           /* Packets counted in queue_delay */
+  uint16_t acks;              /* ACKs counted in ack_latency */
+  uint16_t retries;           /* Transmissions after the first one */
+  uint16_t cca_failures;
+};
+
+/* The attempt of the RDC, sending from process context */
+extern struct mac_stats mac_stats_current;
+extern struct mac_stats_counters mac_stats_total;
+
+/* Stamp the packet in packetbuf before it is queued */
+void mac_stats_enqueued(void);
+/* Report an attempt on the packet in packetbuf and reset its statistics */
+void mac_stats_sent(struct mac_stats *stats, int status, int num_tx);
+
+#define MAC_STATS_ENQUEUED()              mac_stats_enqueued()
+#define MAC_STATS_TX(stats)               do { if((stats).first_tx == 0) { \
+                                            (stats).first_tx = (uint16_t)clock_time() | 1; } } while(0)
+#define MAC_STATS_CCA_FAILED(stats)       ((stats).cca_failures++)
+#define MAC_STATS_ACK(stats, latency)     do { (stats).ack_latency += (latency); (stats).acks++; } while(0)
+#define MAC_STATS_RADIO_ON(stats, time)   ((stats).radio_on += (time))
+#define MAC_STATS_SENT(stats, status, num_tx) mac_stats_sent(&(stats), (status), (num_tx))
+#else /* MAC_WITH_STATS */
+#define MAC_STATS_ENQUEUED()
+#define MAC_STATS_TX(stats)
+#define MAC_STATS_CCA_FAILED(stats)
+#define MAC_STATS_ACK(stats, latency)
+#define MAC_STATS_RADIO_ON(stats, time)
+#define MAC_STATS_SENT(stats, status, num_tx)
+#endif /* MAC_WITH_STATS */
+
 /**
  * The structure of a MAC protocol driver in Contiki.
  */
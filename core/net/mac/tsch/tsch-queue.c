@@ -77,6 +77,212 @@ LIST(neighbor_list);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_WITH_INDEX
+#if TSCH_QUEUE_HASH_SIZE & (TSCH_QUEUE_HASH_SIZE - 1)
+#error TSCH_QUEUE_HASH_SIZE must be a power of two
+#endif
+#if TSCH_QUEUE_HASH_SIZE <= TSCH_QUEUE_MAX_NEIGHBOR_QUEUES
+#error TSCH_QUEUE_HASH_SIZE must be larger than TSCH_QUEUE_MAX_NEIGHBOR_QUEUES
+#endif
+#if (TSCH_QUEUE_INDEX_PENDING & (TSCH_QUEUE_INDEX_PENDING - 1)) != 0 || TSCH_QUEUE_INDEX_PENDING > 128
+#error TSCH_QUEUE_INDEX_PENDING must be a power of two, at most 128
+#endif
+
+/* A neighbor index in neighbor_memb, or that index plus one */
+#if TSCH_QUEUE_MAX_NEIGHBOR_QUEUES < 256
+typedef uint8_t nbr_index_t;
+#else
+typedef uint16_t nbr_index_t;
+#endif
+
+/* Hash index of the neighbors by address, with linear probing. A slot
+ * holds the neighbor index in neighbor_memb plus one, or zero when empty.
+ * It is only modified with the lock held, so the slot operation can read it. */
+static nbr_index_t hash_slots[TSCH_QUEUE_HASH_SIZE];
+#define HASH_MASK (TSCH_QUEUE_HASH_SIZE - 1)
+
+/* Bitmaps of the neighbors that may send in a shared slot (unicast, with a
+ * packet, no Tx link and no backoff), and of the neighbors that may be in
+ * backoff. They may hold extra neighbors, which are dropped when visited.
+ * Only the slot operation writes them, or else code holding the lock. */
+#define BITMAP_SIZE ((TSCH_QUEUE_MAX_NEIGHBOR_QUEUES + 7) / 8)
+static uint8_t ready_bitmap[BITMAP_SIZE];
+static uint8_t backoff_bitmap[BITMAP_SIZE];
+
+/* Neighbors that may have become ready, handed over by the process context
+ * to the slot operation. Lock-free, as the neighbor queues. */
+static nbr_index_t pending_array[TSCH_QUEUE_INDEX_PENDING];
+static struct ringbufindex pending_ringbuf;
+/* Set when the bitmaps must be rebuilt from the neighbor list */
+static volatile uint8_t index_stale;
+#endif /* TSCH_QUEUE_WITH_INDEX */
+
+#if TSCH_QUEUE_WITH_INDEX
+/*---------------------------------------------------------------------------*/
+static struct tsch_neighbor *
+nbr_from_index(int index)
+{
+  return &((struct tsch_neighbor *)neighbor_memb.mem)[index];
+}
+/*---------------------------------------------------------------------------*/
+static int
+index_from_nbr(const struct tsch_neighbor *n)
+{
+  return n - (struct tsch_neighbor *)neighbor_memb.mem;
+}
+/*---------------------------------------------------------------------------*/
+static int
+bitmap_get(const uint8_t *bitmap, int index)
+{
+  return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bitmap_set(uint8_t *bitmap, int index)
+{
+  bitmap[index >> 3] |= 1 << (index & 7);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bitmap_clear(uint8_t *bitmap, int index)
+{
+  bitmap[index >> 3] &= ~(1 << (index & 7));
+}
+/*---------------------------------------------------------------------------*/
+/* Home slot of a link-layer address */
+static unsigned
+hash_linkaddr(const linkaddr_t *addr)
+{
+  unsigned h = 0;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = h * 31 + addr->u8[i];
+  }
+  return (h ^ (h >> 8)) & HASH_MASK;
+}
+/*---------------------------------------------------------------------------*/
+/* Slot of the neighbor with the given address, or of the empty slot that
+ * ends its probe sequence */
+static unsigned
+hash_find(const linkaddr_t *addr)
+{
+  unsigned slot = hash_linkaddr(addr);
+  while(hash_slots[slot] != 0 &&
+        !linkaddr_cmp(addr, &nbr_from_index(hash_slots[slot] - 1)->addr)) {
+    slot = (slot + 1) & HASH_MASK;
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a neighbor to the index. Called with the lock held. */
+static void
+index_add_nbr(const struct tsch_neighbor *n)
+{
+  int index = index_from_nbr(n);
+  hash_slots[hash_find(&n->addr)] = index + 1;
+  bitmap_clear(ready_bitmap, index);
+  bitmap_clear(backoff_bitmap, index);
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a neighbor from the index. Called with the lock held. Entries
+ * further down the probe sequence are shifted back, so that no tombstones
+ * are needed. */
+static void
+index_remove_nbr(const struct tsch_neighbor *n)
+{
+  unsigned hole = hash_find(&n->addr);
+  unsigned slot = hole;
+  unsigned home;
+
+  bitmap_clear(ready_bitmap, index_from_nbr(n));
+  bitmap_clear(backoff_bitmap, index_from_nbr(n));
+  if(hash_slots[hole] == 0) {
+    return;
+  }
+  while(1) {
+    slot = (slot + 1) & HASH_MASK;
+    if(hash_slots[slot] == 0) {
+      break;
+    }
+    home = hash_linkaddr(&nbr_from_index(hash_slots[slot] - 1)->addr);
+    /* Keep the entry if its home slot is cyclically in (hole, slot] */
+    if(hole <= slot ? (hole < home && home <= slot)
+                    : (hole < home || home <= slot)) {
+      continue;
+    }
+    hash_slots[hole] = hash_slots[slot];
+    hole = slot;
+  }
+  hash_slots[hole] = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* May the neighbor send in any shared slot? */
+static int
+is_ready(const struct tsch_neighbor *n)
+{
+  return !n->is_broadcast && n->tx_links_count == 0
+         && n->backoff_window == 0 && !ringbufindex_empty(&n->tx_ringbuf);
+}
+/*---------------------------------------------------------------------------*/
+/* Bring the bitmaps up to date with the neighbors handed over by the
+ * process context. Called from the slot operation. */
+static void
+index_update(void)
+{
+  int16_t get_index;
+
+  if(index_stale) {
+    struct tsch_neighbor *n;
+    index_stale = 0;
+    while(ringbufindex_get(&pending_ringbuf) != -1);
+    memset(ready_bitmap, 0, sizeof(ready_bitmap));
+    memset(backoff_bitmap, 0, sizeof(backoff_bitmap));
+    for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+      if(is_ready(n)) {
+        bitmap_set(ready_bitmap, index_from_nbr(n));
+      }
+      if(n->backoff_window != 0) {
+        bitmap_set(backoff_bitmap, index_from_nbr(n));
+      }
+    }
+    return;
+  }
+
+  while((get_index = ringbufindex_get(&pending_ringbuf)) != -1) {
+    int index = pending_array[get_index];
+    /* Skip neighbors that were removed in the meantime */
+    if(neighbor_memb.count[index] != 0 && is_ready(nbr_from_index(index))) {
+      bitmap_set(ready_bitmap, index);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Tell the slot operation that a neighbor may now send in shared slots */
+void
+tsch_queue_notify_nbr(const struct tsch_neighbor *n)
+{
+  int index;
+  int16_t put_index;
+
+  if(n == NULL || n->is_broadcast) {
+    return;
+  }
+  index = index_from_nbr(n);
+  if(bitmap_get(ready_bitmap, index)) {
+    /* Already indexed */
+    return;
+  }
+  put_index = ringbufindex_peek_put(&pending_ringbuf);
+  if(put_index == -1) {
+    /* No room left: have the whole index rebuilt */
+    index_stale = 1;
+    return;
+  }
+  pending_array[put_index] = index;
+  ringbufindex_put(&pending_ringbuf);
+}
+#endif /* TSCH_QUEUE_WITH_INDEX */
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -99,6 +305,9 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
         tsch_queue_backoff_reset(n);
         /* Add neighbor to the list */
         list_add(neighbor_list, n);
+#if TSCH_QUEUE_WITH_INDEX
+        index_add_nbr(n);
+#endif /* TSCH_QUEUE_WITH_INDEX */
       }
       tsch_release_lock();
     }
@@ -111,6 +320,12 @@ struct tsch_neighbor *
 tsch_queue_get_nbr(const linkaddr_t *addr)
 {
   if(!tsch_is_locked()) {
+#if TSCH_QUEUE_WITH_INDEX
+    nbr_index_t slot = hash_slots[hash_find(addr)];
+    if(slot != 0) {
+      return nbr_from_index(slot - 1);
+    }
+#else /* TSCH_QUEUE_WITH_INDEX */
     struct tsch_neighbor *n = list_head(neighbor_list);
     while(n != NULL) {
       if(linkaddr_cmp(&n->addr, addr)) {
@@ -118,6 +333,7 @@ tsch_queue_get_nbr(const linkaddr_t *addr)
       }
       n = list_item_next(n);
     }
+#endif /* TSCH_QUEUE_WITH_INDEX */
   }
   return NULL;
 }
@@ -215,6 +431,9 @@ tsch_queue_remove_nbr(struct tsch_neighbor *n)
 
       /* Remove neighbor from list */
       list_remove(neighbor_list, n);
+#if TSCH_QUEUE_WITH_INDEX
+      index_remove_nbr(n);
+#endif /* TSCH_QUEUE_WITH_INDEX */
 
       tsch_release_lock();
 
@@ -251,9 +470,16 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
             p->ptr = ptr;
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
+#if MAC_WITH_STATS
+            memset(&p->stats, 0, sizeof(p->stats));
+#endif /* MAC_WITH_STATS */
             /* Add to ringbuf (actual add committed through atomic operation) */
             n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
+#if TSCH_QUEUE_WITH_INDEX
+            /* Only now that the packet is committed */
+            tsch_queue_notify_nbr(n);
+#endif /* TSCH_QUEUE_WITH_INDEX */
             PRINTF("TSCH-queue: packet is added put_index=%u, packet=%p\n",
                    put_index, p);
             return p;
@@ -326,6 +552,9 @@ tsch_queue_reset(void)
       tsch_queue_backoff_reset(n);
       n = next_n;
     }
+#if TSCH_QUEUE_WITH_INDEX
+    index_stale = 1;
+#endif /* TSCH_QUEUE_WITH_INDEX */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -400,8 +629,41 @@ struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *curr_nbr = list_head(neighbor_list);
+    struct tsch_neighbor *curr_nbr;
     struct tsch_packet *p = NULL;
+#if TSCH_QUEUE_WITH_INDEX
+    /* In shared slots, only visit the neighbors out of backoff with a packet.
+     * Dedicated slots ignore the backoff: fall back to a full scan. */
+    if(link != NULL && (link->link_options & LINK_OPTION_SHARED)) {
+      int i, j;
+      index_update();
+      for(i = 0; i < BITMAP_SIZE; i++) {
+        if(ready_bitmap[i] == 0) {
+          continue;
+        }
+        for(j = i * 8; j < i * 8 + 8; j++) {
+          if(!bitmap_get(ready_bitmap, j)) {
+            continue;
+          }
+          curr_nbr = nbr_from_index(j);
+          if(!is_ready(curr_nbr)) {
+            /* Sent all its packets, or got a Tx link or a backoff since */
+            bitmap_clear(ready_bitmap, j);
+            continue;
+          }
+          p = tsch_queue_get_packet_for_nbr(curr_nbr, link);
+          if(p != NULL) {
+            if(n != NULL) {
+              *n = curr_nbr;
+            }
+            return p;
+          }
+        }
+      }
+      return NULL;
+    }
+#endif /* TSCH_QUEUE_WITH_INDEX */
+    curr_nbr = list_head(neighbor_list);
     while(curr_nbr != NULL) {
       if(!curr_nbr->is_broadcast && curr_nbr->tx_links_count == 0) {
         /* Only look up for non-broadcast neighbors we do not have a tx link to */
@@ -447,6 +709,11 @@ tsch_queue_backoff_inc(struct tsch_neighbor *n)
   /* Add one to the window as we will decrement it at the end of the current slot
    * through tsch_queue_update_all_backoff_windows */
   n->backoff_window++;
+#if TSCH_QUEUE_WITH_INDEX
+  /* Called from the slot operation */
+  bitmap_set(backoff_bitmap, index_from_nbr(n));
+  bitmap_clear(ready_bitmap, index_from_nbr(n));
+#endif /* TSCH_QUEUE_WITH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 /* Decrement backoff window for all queues directed at dest_addr */
@@ -455,6 +722,35 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
 {
   if(!tsch_is_locked()) {
     int is_broadcast = linkaddr_cmp(dest_addr, &tsch_broadcast_address);
+#if TSCH_QUEUE_WITH_INDEX
+    /* Only visit the neighbors that may be in backoff */
+    int i, j;
+    index_update();
+    for(i = 0; i < BITMAP_SIZE; i++) {
+      if(backoff_bitmap[i] == 0) {
+        continue;
+      }
+      for(j = i * 8; j < i * 8 + 8; j++) {
+        struct tsch_neighbor *n;
+        if(!bitmap_get(backoff_bitmap, j)) {
+          continue;
+        }
+        n = nbr_from_index(j);
+        if(n->backoff_window != 0
+           && ((n->tx_links_count == 0 && is_broadcast)
+               || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, &n->addr)))) {
+          n->backoff_window--;
+        }
+        if(n->backoff_window == 0) {
+          /* Out of backoff (or reset): may send in shared slots again */
+          bitmap_clear(backoff_bitmap, j);
+          if(is_ready(n)) {
+            bitmap_set(ready_bitmap, j);
+          }
+        }
+      }
+    }
+#else /* TSCH_QUEUE_WITH_INDEX */
     struct tsch_neighbor *n = list_head(neighbor_list);
     while(n != NULL) {
       if(n->backoff_window != 0 /* Is the queue in backoff state? */
@@ -464,6 +760,7 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
       }
       n = list_item_next(n);
     }
+#endif /* TSCH_QUEUE_WITH_INDEX */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -474,6 +771,13 @@ tsch_queue_init(void)
   list_init(neighbor_list);
   memb_init(&neighbor_memb);
   memb_init(&packet_memb);
+#if TSCH_QUEUE_WITH_INDEX
+  memset(hash_slots, 0, sizeof(hash_slots));
+  memset(ready_bitmap, 0, sizeof(ready_bitmap));
+  memset(backoff_bitmap, 0, sizeof(backoff_bitmap));
+  ringbufindex_init(&pending_ringbuf, TSCH_QUEUE_INDEX_PENDING);
+  index_stale = 0;
+#endif /* TSCH_QUEUE_WITH_INDEX */
   /* Add virtual EB and the broadcast neighbors */
   n_eb = tsch_queue_add_nbr(&tsch_eb_address);
   n_broadcast = tsch_queue_add_nbr(&tsch_broadcast_address);
@@ -77,6 +77,50 @@
 #define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES ((NBR_TABLE_CONF_MAX_NEIGHBORS) + 2)
 #endif
 
+/* Index the neighbor queues, so that the slot operation does not scan the
+ * neighbor list: neighbors are found by address in a hash table, and the
+ * neighbors that may send in a shared slot, as well as those in backoff,
+ * are tracked in bitmaps */
+#ifdef TSCH_QUEUE_CONF_WITH_INDEX
+#define TSCH_QUEUE_WITH_INDEX TSCH_QUEUE_CONF_WITH_INDEX
+#else
+#define TSCH_QUEUE_WITH_INDEX 0
+#endif
+
+/* Number of hash slots of the index, a power of two larger than the
+ * number of neighbor queues. The default keeps the load factor at or
+ * below one half. */
+#ifdef TSCH_QUEUE_CONF_HASH_SIZE
+#define TSCH_QUEUE_HASH_SIZE TSCH_QUEUE_CONF_HASH_SIZE
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 4
+#define TSCH_QUEUE_HASH_SIZE 8
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 8
+#define TSCH_QUEUE_HASH_SIZE 16
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 16
+#define TSCH_QUEUE_HASH_SIZE 32
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 32
+#define TSCH_QUEUE_HASH_SIZE 64
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 64
+#define TSCH_QUEUE_HASH_SIZE 128
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 128
+#define TSCH_QUEUE_HASH_SIZE 256
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 256
+#define TSCH_QUEUE_HASH_SIZE 512
+#elif TSCH_QUEUE_MAX_NEIGHBOR_QUEUES <= 512
+#define TSCH_QUEUE_HASH_SIZE 1024
+#else
+#define TSCH_QUEUE_HASH_SIZE 2048
+#endif
+
+/* How many neighbors whose queue became non-empty can be handed over to
+ * the slot operation between two of its index updates (power of two).
+ * Beyond that, the slot operation rebuilds the index from scratch. */
+#ifdef TSCH_QUEUE_CONF_INDEX_PENDING
+#define TSCH_QUEUE_INDEX_PENDING TSCH_QUEUE_CONF_INDEX_PENDING
+#else
+#define TSCH_QUEUE_INDEX_PENDING 8
+#endif
+
 /* TSCH CSMA-CA parameters, see IEEE 802.15.4e-2012 */
 /* Min backoff exponent */
 #ifdef TSCH_CONF_MAC_MIN_BE
@@ -121,6 +165,9 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if MAC_WITH_STATS
+  struct mac_stats stats; /* MAC statistics, handed to link-stats once sent */
+#endif /* MAC_WITH_STATS */
 };
 
 /* TSCH neighbor information */
@@ -190,5 +237,10 @@ void tsch_queue_backoff_inc(struct tsch_neighbor *n);
 void tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr);
 /* Initialize TSCH queue module */
 void tsch_queue_init(void);
+#if TSCH_QUEUE_WITH_INDEX
+/* Tell the slot operation that a neighbor may now send in shared slots,
+ * e.g. after its last Tx link was removed */
+void tsch_queue_notify_nbr(const struct tsch_neighbor *n);
+#endif /* TSCH_QUEUE_WITH_INDEX */
 
 #endif /* __TSCH_QUEUE_H__ */
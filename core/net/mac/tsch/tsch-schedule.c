@@ -69,6 +69,73 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_SCHEDULE_WITH_INDEX
+/* Schedule index: pointers to all links, grouped by slotframe in the order
+ * of slotframe_list, and sorted by timeslot within each slotframe */
+static struct tsch_link *link_index[TSCH_SCHEDULE_MAX_LINKS];
+static uint16_t link_index_len;
+
+/*---------------------------------------------------------------------------*/
+/* Returns the position in the index of the first link of a slotframe with
+ * a timeslot greater or equal to a given one */
+static uint16_t
+index_lower_bound(const struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  uint16_t low = sf->index_start;
+  uint16_t high = sf->index_start + sf->index_count;
+  while(low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if(link_index[mid]->timeslot < timeslot) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+/*---------------------------------------------------------------------------*/
+/* Inserts a link in the index. Called with the lock held. */
+static void
+index_add_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
+{
+  struct tsch_slotframe *sf;
+  uint16_t pos = index_lower_bound(slotframe, l->timeslot);
+
+  memmove(&link_index[pos + 1], &link_index[pos],
+          (link_index_len - pos) * sizeof(link_index[0]));
+  link_index[pos] = l;
+  link_index_len++;
+  slotframe->index_count++;
+  /* The links of the next slotframes moved up by one */
+  for(sf = list_item_next(slotframe); sf != NULL; sf = list_item_next(sf)) {
+    sf->index_start++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Removes a link from the index. Called with the lock held. */
+static void
+index_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
+{
+  struct tsch_slotframe *sf;
+  uint16_t end = slotframe->index_start + slotframe->index_count;
+  uint16_t pos = index_lower_bound(slotframe, l->timeslot);
+
+  while(pos < end && link_index[pos] != l) {
+    pos++;
+  }
+  if(pos == end) {
+    return;
+  }
+  link_index_len--;
+  memmove(&link_index[pos], &link_index[pos + 1],
+          (link_index_len - pos) * sizeof(link_index[0]));
+  slotframe->index_count--;
+  for(sf = list_item_next(slotframe); sf != NULL; sf = list_item_next(sf)) {
+    sf->index_start--;
+  }
+}
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -89,6 +156,11 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       sf->handle = handle;
       TSCH_ASN_DIVISOR_INIT(sf->size, size);
       LIST_STRUCT_INIT(sf, links_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+      /* The slotframe goes last in the list, its links last in the index */
+      sf->index_start = link_index_len;
+      sf->index_count = 0;
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
     }
@@ -209,6 +281,9 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+#if TSCH_SCHEDULE_WITH_INDEX
+        index_add_link(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
 
         PRINTF("TSCH-schedule: add_link %u %u %u %u %u %u\n",
                slotframe->handle, link_options, link_type, timeslot, channel_offset, TSCH_LOG_ID_FROM_LINKADDR(address));
@@ -256,6 +331,9 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
              TSCH_LOG_ID_FROM_LINKADDR(&l->addr));
 
       list_remove(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_INDEX
+      index_remove_link(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
       memb_free(&link_memb, l);
 
       /* Release the lock before we update the neighbor (will take the lock) */
@@ -269,6 +347,12 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
           if(!(link_options & LINK_OPTION_SHARED)) {
             n->dedicated_tx_links_count--;
           }
+#if TSCH_QUEUE_WITH_INDEX
+          if(n->tx_links_count == 0) {
+            /* Its packets may now go in any shared slot */
+            tsch_queue_notify_nbr(n);
+          }
+#endif /* TSCH_QUEUE_WITH_INDEX */
         }
       }
 
@@ -294,6 +378,14 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe, uint16_t ti
 {
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
+#if TSCH_SCHEDULE_WITH_INDEX
+      uint16_t pos = index_lower_bound(slotframe, timeslot);
+      if(pos < slotframe->index_start + slotframe->index_count
+         && link_index[pos]->timeslot == timeslot) {
+        return link_index[pos];
+      }
+      return NULL;
+#else /* TSCH_SCHEDULE_WITH_INDEX */
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items. Assume there is max one link per timeslot */
       while(l != NULL) {
@@ -303,6 +395,7 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe, uint16_t ti
         l = list_item_next(l);
       }
       return l;
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
     }
   }
   return NULL;
@@ -325,7 +418,21 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+#if TSCH_SCHEDULE_WITH_INDEX
+      /* There is max one link per timeslot: the earliest link of this
+       * slotframe is the first one after the current timeslot, or else the
+       * first one of the next slotframe iteration */
+      struct tsch_link *l = NULL;
+      if(sf->index_count > 0) {
+        uint16_t pos = index_lower_bound(sf, timeslot + 1);
+        if(pos == sf->index_start + sf->index_count) {
+          pos = sf->index_start;
+        }
+        l = link_index[pos];
+      }
+#else /* TSCH_SCHEDULE_WITH_INDEX */
       struct tsch_link *l = list_head(sf->links_list);
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
       while(l != NULL) {
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
@@ -369,7 +476,11 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
           }
         }
 
+#if TSCH_SCHEDULE_WITH_INDEX
+        l = NULL;
+#else /* TSCH_SCHEDULE_WITH_INDEX */
         l = list_item_next(l);
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
       }
       sf = list_item_next(sf);
     }
@@ -391,6 +502,9 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+    link_index_len = 0;
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
     tsch_release_lock();
     return 1;
   } else {
@@ -72,6 +72,15 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep the links of every slotframe sorted by timeslot in an index, so that
+ * the next active link is found by binary search rather than by a scan of
+ * all links. Costs one pointer per link and four bytes per slotframe. */
+#ifdef TSCH_SCHEDULE_CONF_WITH_INDEX
+#define TSCH_SCHEDULE_WITH_INDEX TSCH_SCHEDULE_CONF_WITH_INDEX
+#else
+#define TSCH_SCHEDULE_WITH_INDEX 0
+#endif
+
 /********** Constants *********/
 
 /* Link options */
@@ -122,6 +131,11 @@ struct tsch_slotframe {
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+  /* Position and number of the links of this slotframe in the index */
+  uint16_t index_start;
+  uint16_t index_count;
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
 };
 
 /********** Functions *********/
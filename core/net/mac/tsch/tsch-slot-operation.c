@@ -554,6 +554,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
         /* there is not enough time to turn radio off */
         /*  NETSTACK_RADIO.off(); */
         if(cca_status == 0) {
+          MAC_STATS_CCA_FAILED(current_packet->stats);
           mac_tx_status = MAC_TX_COLLISION;
         } else
 #endif /* CCA_ENABLED */
@@ -569,6 +570,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
           tx_duration = TSCH_PACKET_DURATION(packet_len);
           /* limit tx_time to its max value */
           tx_duration = MIN(tx_duration, tsch_timing[tsch_ts_max_tx]);
+          MAC_STATS_TX(current_packet->stats);
+          MAC_STATS_RADIO_ON(current_packet->stats, tx_duration);
           /* turn tadio off -- will turn on again to wait for ACK if needed */
           tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
@@ -605,6 +608,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                                  ack_start_time, tsch_timing[tsch_ts_max_ack]);
               TSCH_DEBUG_TX_EVENT();
               tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
+              /* The radio was on from the Rx/Ack guard time on */
+              MAC_STATS_RADIO_ON(current_packet->stats, (rtimer_clock_t)(RTIMER_NOW() - (tx_start_time
+                  + tx_duration + tsch_timing[tsch_ts_rx_ack_delay] - RADIO_DELAY_BEFORE_RX)));
 
 #if TSCH_HW_FRAME_FILTERING
               /* Leaving promiscuous mode */
@@ -664,6 +670,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                   last_sync_asn = tsch_current_asn;
                   tsch_schedule_keepalive();
                 }
+                MAC_STATS_ACK(current_packet->stats, (rtimer_clock_t)(ack_start_time - (tx_start_time + tx_duration)));
                 mac_tx_status = MAC_TX_OK;
               } else {
                 mac_tx_status = MAC_TX_NOACK;
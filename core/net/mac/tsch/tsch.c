@@ -383,6 +383,7 @@ tsch_tx_process_pending()
     struct tsch_packet *p = dequeued_array[dequeued_index];
     /* Put packet into packetbuf for packet_sent callback */
     queuebuf_to_packetbuf(p->qb);
+    MAC_STATS_SENT(p->stats, p->ret, p->transmissions);
     /* Call packet_sent callback */
     mac_call_sent_callback(p->sent, p->ptr, p->ret, p->transmissions);
     /* Free packet queuebuf */
@@ -909,6 +910,7 @@ send_packet(mac_callback_t sent, void *ptr)
 #endif /* LLSEC802154_ENABLED */
 
   packet_count_before = tsch_queue_packet_count(addr);
+  MAC_STATS_ENQUEUED();
 
 #if !NETSTACK_CONF_BRIDGE_MODE
   /*
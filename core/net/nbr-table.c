@@ -83,6 +83,25 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_HASH_INDEX
+#if NBR_TABLE_HASH_SIZE & (NBR_TABLE_HASH_SIZE - 1)
+#error NBR_TABLE_HASH_SIZE must be a power of two
+#endif
+#if NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+/* Hash index of the keys, with linear probing. A slot holds the neighbor
+ * index plus one, or zero when empty. As there are more slots than
+ * neighbors, a probe always ends on an empty slot. */
+#if NBR_TABLE_MAX_NEIGHBORS < 256
+typedef uint8_t hash_slot_t;
+#else /* NBR_TABLE_MAX_NEIGHBORS < 256 */
+typedef uint16_t hash_slot_t;
+#endif /* NBR_TABLE_MAX_NEIGHBORS < 256 */
+static hash_slot_t hash_slots[NBR_TABLE_HASH_SIZE];
+#define HASH_MASK (NBR_TABLE_HASH_SIZE - 1)
+#endif /* NBR_TABLE_HASH_INDEX */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -126,16 +145,84 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+#if NBR_TABLE_HASH_INDEX
+/* Home slot of a link-layer address */
+static unsigned
+hash_lladdr(const linkaddr_t *lladdr)
+{
+  unsigned h = 0;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = h * 31 + lladdr->u8[i];
+  }
+  return (h ^ (h >> 8)) & HASH_MASK;
+}
+/*---------------------------------------------------------------------------*/
+/* Slot of the neighbor with the given address, or of the empty slot that
+ * ends its probe sequence */
+static unsigned
+hash_find(const linkaddr_t *lladdr)
+{
+  unsigned slot = hash_lladdr(lladdr);
+  while(hash_slots[slot] != 0 &&
+        !linkaddr_cmp(lladdr, &key_from_index(hash_slots[slot] - 1)->lladdr)) {
+    slot = (slot + 1) & HASH_MASK;
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Index a key under its current link-layer address */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  hash_slots[hash_find(&key->lladdr)] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the index. Entries further down the probe sequence
+ * are shifted back, so that no tombstones are needed. */
+static void
+hash_rm(nbr_table_key_t *key)
+{
+  unsigned hole = hash_find(&key->lladdr);
+  unsigned slot = hole;
+  unsigned home;
+
+  if(hash_slots[hole] == 0) {
+    return;
+  }
+  while(1) {
+    slot = (slot + 1) & HASH_MASK;
+    if(hash_slots[slot] == 0) {
+      break;
+    }
+    home = hash_lladdr(&key_from_index(hash_slots[slot] - 1)->lladdr);
+    /* Keep the entry if its home slot is cyclically in (hole, slot] */
+    if(hole <= slot ? (hole < home && home <= slot)
+                    : (hole < home || home <= slot)) {
+      continue;
+    }
+    hash_slots[hole] = hash_slots[slot];
+    hole = slot;
+  }
+  hash_slots[hole] = 0;
+}
+#endif /* NBR_TABLE_HASH_INDEX */
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
+#if !NBR_TABLE_HASH_INDEX
   nbr_table_key_t *key;
+#endif /* !NBR_TABLE_HASH_INDEX */
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_HASH_INDEX
+  return (int)hash_slots[hash_find(lladdr)] - 1;
+#else /* NBR_TABLE_HASH_INDEX */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -144,6 +231,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -195,6 +283,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_HASH_INDEX
+  hash_rm(least_used_key);
+#endif /* NBR_TABLE_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -359,6 +450,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH_INDEX
+    hash_add(key);
+#endif /* NBR_TABLE_HASH_INDEX */
   }
 
   /* Get item in the current table */
@@ -450,7 +544,13 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
+#if NBR_TABLE_HASH_INDEX
+  hash_rm(key);
+#endif /* NBR_TABLE_HASH_INDEX */
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#if NBR_TABLE_HASH_INDEX
+  hash_add(key);
+#endif /* NBR_TABLE_HASH_INDEX */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -46,6 +46,39 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Index the neighbors by link-layer address in an open-addressing hash
+ * table, so that lookups do not scan the whole table. Costs one byte of
+ * RAM per slot, or two bytes with more than 255 neighbors. */
+#ifdef NBR_TABLE_CONF_HASH_INDEX
+#define NBR_TABLE_HASH_INDEX NBR_TABLE_CONF_HASH_INDEX
+#else /* NBR_TABLE_CONF_HASH_INDEX */
+#define NBR_TABLE_HASH_INDEX 0
+#endif /* NBR_TABLE_CONF_HASH_INDEX */
+
+/* Number of hash slots, a power of two larger than the neighbor table.
+ * The default keeps the load factor at or below one half. */
+#ifdef NBR_TABLE_CONF_HASH_SIZE
+#define NBR_TABLE_HASH_SIZE NBR_TABLE_CONF_HASH_SIZE
+#elif NBR_TABLE_MAX_NEIGHBORS <= 4
+#define NBR_TABLE_HASH_SIZE 8
+#elif NBR_TABLE_MAX_NEIGHBORS <= 8
+#define NBR_TABLE_HASH_SIZE 16
+#elif NBR_TABLE_MAX_NEIGHBORS <= 16
+#define NBR_TABLE_HASH_SIZE 32
+#elif NBR_TABLE_MAX_NEIGHBORS <= 32
+#define NBR_TABLE_HASH_SIZE 64
+#elif NBR_TABLE_MAX_NEIGHBORS <= 64
+#define NBR_TABLE_HASH_SIZE 128
+#elif NBR_TABLE_MAX_NEIGHBORS <= 128
+#define NBR_TABLE_HASH_SIZE 256
+#elif NBR_TABLE_MAX_NEIGHBORS <= 256
+#define NBR_TABLE_HASH_SIZE 512
+#elif NBR_TABLE_MAX_NEIGHBORS <= 512
+#define NBR_TABLE_HASH_SIZE 1024
+#else
+#define NBR_TABLE_HASH_SIZE 2048
+#endif /* NBR_TABLE_CONF_HASH_SIZE */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
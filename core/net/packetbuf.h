@@ -56,6 +56,7 @@
 #include "net/linkaddr.h"
 #include "net/llsec/llsec802154.h"
 #include "net/mac/tsch/tsch-conf.h"
+#include "net/mac/mac.h"
 
 /**
  * \brief      The size of the packetbuf, in bytes
@@ -248,6 +249,9 @@ enum {
   PACKETBUF_ATTR_TSCH_SLOTFRAME,
   PACKETBUF_ATTR_TSCH_TIMESLOT,
 #endif /* TSCH_WITH_LINK_SELECTOR */
+#if MAC_WITH_STATS
+  PACKETBUF_ATTR_MAC_ENQUEUE_TIME,
+#endif /* MAC_WITH_STATS */
 
   /* Scope 1 attributes: used between two neighbors only. */
 #if PACKETBUF_WITH_PACKET_TYPE
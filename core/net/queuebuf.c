@@ -457,6 +457,18 @@ queuebuf_attr(struct queuebuf *b, uint8_t type)
 }
 /*---------------------------------------------------------------------------*/
 void
+queuebuf_set_attr(struct queuebuf *b, uint8_t type, packetbuf_attr_t val)
+{
+  struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  buframptr->attrs[type].val = val;
+#if WITH_SWAP
+  if(b->location == IN_CFS) {
+    queuebuf_flush_tmpdata();
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
+void
 queuebuf_debug_print(void)
 {
 #if QUEUEBUF_DEBUG
@@ -106,6 +106,7 @@ int queuebuf_datalen(struct queuebuf *b);
 
 linkaddr_t *queuebuf_addr(struct queuebuf *b, uint8_t type);
 packetbuf_attr_t queuebuf_attr(struct queuebuf *b, uint8_t type);
+void queuebuf_set_attr(struct queuebuf *b, uint8_t type, packetbuf_attr_t val);
 
 void queuebuf_debug_print(void);
 
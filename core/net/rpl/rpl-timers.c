@@ -47,6 +47,7 @@
 #include "net/link-stats.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "lib/random.h"
+#include "lib/prng.h"
 #include "sys/ctimer.h"
 
 #define DEBUG DEBUG_NONE
@@ -67,6 +68,8 @@ clock_time_t RPL_PROBING_DELAY_FUNC(rpl_dag_t *dag);
 
 /*---------------------------------------------------------------------------*/
 static struct ctimer periodic_timer;
+/* Own pseudo-random stream for Trickle and the other RPL timers */
+PRNG(rpl_prng, PRNG_STREAM_RPL);
 
 static void handle_periodic_timer(void *ptr);
 static void new_dio_interval(rpl_instance_t *instance);
@@ -119,7 +122,7 @@ new_dio_interval(rpl_instance_t *instance)
   instance->dio_next_delay = ticks;
 
   /* random number between I/2 and I */
-  ticks = ticks / 2 + (ticks / 2 * (uint32_t)random_rand()) / RANDOM_RAND_MAX;
+  ticks = ticks / 2 + prng_bounded(&rpl_prng, ticks / 2 + 1);
 
   /*
    * The intervals must be equally long among the nodes for Trickle to
@@ -205,7 +208,7 @@ void
 rpl_reset_periodic_timer(void)
 {
   next_dis = RPL_DIS_INTERVAL / 2 +
-    ((uint32_t)RPL_DIS_INTERVAL * (uint32_t)random_rand()) / RANDOM_RAND_MAX -
+    prng_bounded(&rpl_prng, RPL_DIS_INTERVAL + 1) -
     RPL_DIS_START_DELAY;
   ctimer_set(&periodic_timer, CLOCK_SECOND, handle_periodic_timer, NULL);
 }
@@ -244,7 +247,7 @@ set_dao_lifetime_timer(rpl_instance_t *instance)
       (clock_time_t)instance->lifetime_unit *
       CLOCK_SECOND / 2;
     /* make the time for the re registration be betwen 1/2 - 3/4 of lifetime */
-    expiration_time = expiration_time + (random_rand() % (expiration_time / 2));
+    expiration_time = expiration_time + prng_bounded(&rpl_prng, expiration_time / 2);
     PRINTF("RPL: Scheduling DAO lifetime timer %u ticks in the future\n",
            (unsigned)expiration_time);
     ctimer_set(&instance->dao_lifetime_timer, expiration_time,
@@ -326,7 +329,7 @@ schedule_dao(rpl_instance_t *instance, clock_time_t latency)
   } else {
     if(latency != 0) {
       expiration_time = latency / 2 +
-        (random_rand() % (latency));
+        prng_bounded(&rpl_prng, latency);
     } else {
       expiration_time = 0;
     }
@@ -383,10 +386,10 @@ get_probing_delay(rpl_dag_t *dag)
   if(dag != NULL && dag->instance != NULL
       && dag->instance->urgent_probing_target != NULL) {
     /* Urgent probing needed (to find out if a neighbor may become preferred parent) */
-    return random_rand() % (CLOCK_SECOND * 10);
+    return prng_bounded(&rpl_prng, CLOCK_SECOND * 10);
   } else {
     /* Else, use normal probing interval */
-    return ((RPL_PROBING_INTERVAL) / 2) + random_rand() % (RPL_PROBING_INTERVAL);
+    return ((RPL_PROBING_INTERVAL) / 2) + prng_bounded(&rpl_prng, RPL_PROBING_INTERVAL);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -422,7 +425,7 @@ get_probing_target(rpl_dag_t *dag)
   }
 
   /* With 50% probability: probe best non-fresh parent */
-  if(random_rand() % 2 == 0) {
+  if((prng_next32(&rpl_prng) & 0x80000000) == 0) {
     p = nbr_table_head(rpl_parents);
     while(p != NULL) {
       if(p->dag == dag && !rpl_parent_is_fresh(p)) {
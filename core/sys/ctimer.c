@@ -46,6 +46,8 @@
 #include "contiki.h"
 #include "lib/list.h"
 
+#include <stddef.h>
+
 LIST(ctimer_list);
 
 static char initialized;
@@ -59,35 +61,43 @@ static char initialized;
 #endif
 
 /*---------------------------------------------------------------------------*/
+/*
+ * Callback timers are event timers of ctimer_process. The event timer
+ * library calls ctimer_expire() directly when they expire. The list
+ * only holds the callback timers set before the library is initialized.
+ */
 PROCESS(ctimer_process, "Ctimer process");
 PROCESS_THREAD(ctimer_process, ev, data)
 {
   struct ctimer *c;
   PROCESS_BEGIN();
 
-  for(c = list_head(ctimer_list); c != NULL; c = c->next) {
+  while((c = list_pop(ctimer_list)) != NULL) {
     etimer_set(&c->etimer, c->etimer.timer.interval);
   }
   initialized = 1;
 
   while(1) {
-    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
-    for(c = list_head(ctimer_list); c != NULL; c = c->next) {
-      if(&c->etimer == data) {
-	list_remove(ctimer_list, c);
-	PROCESS_CONTEXT_BEGIN(c->p);
-	if(c->f != NULL) {
-	  c->f(c->ptr);
-	}
-	PROCESS_CONTEXT_END(c->p);
-	break;
-      }
-    }
+    PROCESS_YIELD();
   }
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
 void
+ctimer_expire(struct etimer *et)
+{
+  struct ctimer *c;
+
+  c = (struct ctimer *)((char *)et - offsetof(struct ctimer, etimer));
+  PRINTF("ctimer_expire %p\n", c);
+  PROCESS_CONTEXT_BEGIN(c->p);
+  if(c->f != NULL) {
+    c->f(c->ptr);
+  }
+  PROCESS_CONTEXT_END(c->p);
+}
+/*---------------------------------------------------------------------------*/
+void
 ctimer_init(void)
 {
   initialized = 0;
@@ -116,9 +126,8 @@ ctimer_set_with_process(struct ctimer *c, clock_time_t t,
     PROCESS_CONTEXT_END(&ctimer_process);
   } else {
     c->etimer.timer.interval = t;
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -128,9 +137,9 @@ ctimer_reset(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_reset(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -140,9 +149,9 @@ ctimer_restart(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_restart(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -151,10 +160,10 @@ ctimer_stop(struct ctimer *c)
   if(initialized) {
     etimer_stop(&c->etimer);
   } else {
-    c->etimer.next = NULL;
+    c->etimer.next = c->etimer.prev = NULL;
     c->etimer.p = PROCESS_NONE;
+    list_remove(ctimer_list, c);
   }
-  list_remove(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 int
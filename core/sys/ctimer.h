@@ -161,6 +161,19 @@ int ctimer_expired(struct ctimer *c);
  */
 void ctimer_init(void);
 
+/**
+ * \brief      Call the function of an expired callback timer.
+ * \param et   A pointer to the event timer of the callback timer.
+ *
+ *             This function is called by the event timer library when
+ *             the event timer of a callback timer expires, so that
+ *             callbacks run without a process event in between. It
+ *             should not be called from application programs.
+ */
+void ctimer_expire(struct etimer *et);
+
+PROCESS_NAME(ctimer_process);
+
 #endif /* CTIMER_H_ */
 /** @} */
 /** @} */
@@ -44,100 +44,238 @@
  * Adam Dunkels <adam@sics.se>
  */
 
+
 #include "contiki-conf.h"
 
 #include "sys/etimer.h"
+#include "sys/ctimer.h"
 #include "sys/process.h"
 
+/*
+ * Pending event timers are kept in a pairing heap ordered by
+ * expiration time, with the next timer to expire at the root. In a
+ * heap node, next points to the next sibling, child to the first
+ * child and prev to the parent (for a first child) or to the previous
+ * sibling. Adding a timer is O(1), the next expiration time is read
+ * from the root and removing a timer is O(log n) amortized. Callback
+ * timers share the heap and their functions are called from here.
+ */
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+/* Returns non-zero if a expires before b. Remaining times are compared
+   as a.interval - elapsed(a) < b.interval - elapsed(b), rearranged so
+   that both sides are unsigned and the order stays the same once the
+   timers have expired. */
+static int
+expires_before(struct etimer *a, struct etimer *b, clock_time_t now)
+{
+  clock_time_t x, y;
+
+  x = a->timer.interval + (clock_time_t)(now - b->timer.start);
+  y = b->timer.interval + (clock_time_t)(now - a->timer.start);
+  if((x < a->timer.interval) != (y < b->timer.interval)) {
+    /* Exactly one of the sums overflowed */
+    return y < b->timer.interval;
+  }
+  return x < y;
+}
+/*---------------------------------------------------------------------------*/
+/* Merges two heaps and returns the new root */
+static struct etimer *
+meld(struct etimer *a, struct etimer *b, clock_time_t now)
+{
+  struct etimer *t;
+
+  if(a == NULL) {
+    return b;
+  }
+  if(b == NULL) {
+    return a;
+  }
+  if(expires_before(b, a, now)) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  b->prev = a;
+  b->next = a->child;
+  if(a->child != NULL) {
+    a->child->prev = b;
+  }
+  a->child = b;
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+/* Merges a list of sibling heaps in two passes: pairwise from left to
+   right, then the pairs from right to left. */
+static struct etimer *
+merge_pairs(struct etimer *first, clock_time_t now)
+{
+  struct etimer *a, *b, *pairs, *root;
+
+  pairs = NULL;
+  while(first != NULL) {
+    a = first;
+    b = a->next;
+    first = b != NULL ? b->next : NULL;
+    a->next = a->prev = NULL;
+    if(b != NULL) {
+      b->next = b->prev = NULL;
+    }
+    a = meld(a, b, now);
+    a->next = pairs;
+    pairs = a;
+  }
+
+  root = NULL;
+  while(pairs != NULL) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    root = meld(root, a, now);
+  }
+  return root;
+}
+/*---------------------------------------------------------------------------*/
+/* Every timer in the heap but the root has a parent or a previous
+   sibling, and heap_remove() clears prev, so this does not need to
+   follow the pointers of a timer that has left the heap. */
+static int
+is_pending(struct etimer *t)
+{
+  return t == timerlist || t->prev != NULL;
+}
+/*---------------------------------------------------------------------------*/
 static void
-update_time(void)
+heap_insert(struct etimer *t)
+{
+  t->next = t->child = t->prev = NULL;
+  timerlist = meld(timerlist, t, clock_time());
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(struct etimer *t)
 {
-  clock_time_t tdist;
   clock_time_t now;
-  struct etimer *t;
 
-  if (timerlist == NULL) {
-    next_expiration = 0;
+  now = clock_time();
+  if(t == timerlist) {
+    timerlist = merge_pairs(t->child, now);
   } else {
-    now = clock_time();
-    t = timerlist;
-    /* Must calculate distance to next time into account due to wraps */
-    tdist = t->timer.start + t->timer.interval - now;
-    for(t = t->next; t != NULL; t = t->next) {
-      if(t->timer.start + t->timer.interval - now < tdist) {
-	tdist = t->timer.start + t->timer.interval - now;
+    if(t->prev->child == t) {
+      t->prev->child = t->next;
+    } else {
+      t->prev->next = t->next;
+    }
+    if(t->next != NULL) {
+      t->next->prev = t->prev;
+    }
+    timerlist = meld(timerlist, merge_pairs(t->child, now), now);
+  }
+  t->next = t->child = t->prev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns a pending timer of process p, NULL if there is none */
+static struct etimer *
+find_process(struct process *p)
+{
+  struct etimer *t;
+
+  t = timerlist;
+  while(t != NULL) {
+    if(t->p == p) {
+      return t;
+    }
+    if(t->child != NULL) {
+      t = t->child;
+      continue;
+    }
+    /* Climb until a node with a next sibling; the root has none */
+    while(t != NULL && t->next == NULL) {
+      while(t->prev != NULL && t->prev->child != t) {
+        t = t->prev;
       }
+      t = t->prev;
     }
-    next_expiration = now + tdist;
+    if(t != NULL) {
+      t = t->next;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_time(void)
+{
+  if(timerlist == NULL) {
+    next_expiration = 0;
+  } else {
+    next_expiration = timerlist->timer.start + timerlist->timer.interval;
   }
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
 {
-  struct etimer *t, *u;
-	
+  struct etimer *t;
+  int posted;
+
   PROCESS_BEGIN();
 
   timerlist = NULL;
-  
+  /* Timer expiry, and the callback timers of the network stacks, are
+     not delayed by a backlog of data events */
+  process_set_priority(&etimer_process, PROCESS_PRIORITY_HIGH);
+
   while(1) {
     PROCESS_YIELD();
 
     if(ev == PROCESS_EVENT_EXITED) {
       struct process *p = data;
 
-      while(timerlist != NULL && timerlist->p == p) {
-	timerlist = timerlist->next;
-      }
-
-      if(timerlist != NULL) {
-	t = timerlist;
-	while(t->next != NULL) {
-	  if(t->next->p == p) {
-	    t->next = t->next->next;
-	  } else
-	    t = t->next;
-	}
+      while((t = find_process(p)) != NULL) {
+        heap_remove(t);
       }
+      update_time();
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
     }
 
-  again:
-    
-    u = NULL;
-    
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(timer_expired(&t->timer)) {
-	if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
-	  
-	  /* Reset the process ID of the event timer, to signal that the
-	     etimer has expired. This is later checked in the
-	     etimer_expired() function. */
-	  t->p = PROCESS_NONE;
-	  if(u != NULL) {
-	    u->next = t->next;
-	  } else {
-	    timerlist = t->next;
-	  }
-	  t->next = NULL;
-	  update_time();
-	  goto again;
-	} else {
-	  etimer_request_poll();
-	}
+    /* No other timer can have expired before the root has */
+    posted = 0;
+    while(timerlist != NULL && timer_expired(&timerlist->timer)) {
+      t = timerlist;
+      if(t->p == &ctimer_process) {
+        /* A callback runs after the events posted before it, as if it
+           were an event itself. At most one callback runs per poll,
+           so that one which sets its timer again cannot keep the other
+           processes from running. */
+        if(!posted) {
+          heap_remove(t);
+          t->p = PROCESS_NONE;
+          update_time();
+          ctimer_expire(t);
+        }
+        etimer_request_poll();
+        break;
+      } else if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+        heap_remove(t);
+        /* Reset the process ID of the event timer, to signal that the
+           etimer has expired. This is later checked in the
+           etimer_expired() function. */
+        t->p = PROCESS_NONE;
+        update_time();
+        posted = 1;
+      } else {
+        etimer_request_poll();
+        break;
       }
-      u = t;
     }
-    
   }
-  
+
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
@@ -150,25 +288,16 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
-  struct etimer *t;
-
   etimer_request_poll();
 
-  if(timer->p != PROCESS_NONE) {
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(t == timer) {
-	/* Timer already on list, bail out. */
-        timer->p = PROCESS_CURRENT();
-	update_time();
-	return;
-      }
-    }
+  /* A timer already in the heap has a new expiration time and must be
+     moved to its new position. */
+  if(timer->p != PROCESS_NONE && is_pending(timer)) {
+    heap_remove(timer);
   }
 
-  /* Timer not on list. */
   timer->p = PROCESS_CURRENT();
-  timer->next = timerlist;
-  timerlist = timer;
+  heap_insert(timer);
 
   update_time();
 }
@@ -205,7 +334,13 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
-  et->timer.start += timediff;
+  if(et->p != PROCESS_NONE && is_pending(et)) {
+    heap_remove(et);
+    et->timer.start += timediff;
+    heap_insert(et);
+  } else {
+    et->timer.start += timediff;
+  }
   update_time();
 }
 /*---------------------------------------------------------------------------*/
@@ -239,32 +374,32 @@ etimer_next_expiration_time(void)
   return etimer_pending() ? next_expiration : 0;
 }
 /*---------------------------------------------------------------------------*/
+clock_time_t
+etimer_next_wakeup(void)
+{
+  clock_time_t now;
+
+  if(process_nevents() > 0) {
+    return 0;
+  }
+  if(timerlist == NULL) {
+    return ETIMER_NO_WAKEUP;
+  }
+  now = clock_time();
+  if(timer_expired(&timerlist->timer)) {
+    return 0;
+  }
+  return timerlist->timer.start + timerlist->timer.interval - now;
+}
+/*---------------------------------------------------------------------------*/
 void
 etimer_stop(struct etimer *et)
 {
-  struct etimer *t;
-
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
+  if(et->p != PROCESS_NONE && is_pending(et)) {
+    heap_remove(et);
     update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next);
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-	 to remove. We point the items next pointer to the event after
-	 the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
   }
 
-  /* Remove the next pointer from the item to be removed. */
-  et->next = NULL;
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
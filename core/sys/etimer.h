@@ -76,6 +76,8 @@
 struct etimer {
   struct timer timer;
   struct etimer *next;
+  struct etimer *child;
+  struct etimer *prev;
   struct process *p;
 };
 
@@ -245,6 +247,25 @@ int etimer_pending(void);
  */
 clock_time_t etimer_next_expiration_time(void);
 
+/**
+ * Returned by etimer_next_wakeup() when no event timer is pending.
+ */
+#define ETIMER_NO_WAKEUP ((clock_time_t)~(clock_time_t)0)
+
+/**
+ * \brief      Get the time until the system must wake up.
+ * \return     The number of clock ticks until the next event or
+ *             callback timer expires, 0 if processes have events
+ *             pending or a timer has already expired, and
+ *             ETIMER_NO_WAKEUP if no timer is pending.
+ *
+ *             This function is meant for the idle loop of a
+ *             platform, which may sleep for the returned time and
+ *             then call etimer_request_poll(), instead of waking up
+ *             periodically to check the event timers.
+ */
+clock_time_t etimer_next_wakeup(void);
+
 
 /** @} */
 
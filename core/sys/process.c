@@ -65,14 +65,34 @@ struct event_data {
   struct process *p;
 };
 
-static process_num_events_t nevents, fevent;
-static struct event_data events[PROCESS_CONF_NUMEVENTS];
+#if PROCESS_PRIORITIES > 8
+#error "PROCESS_CONF_PRIORITIES must be at most 8"
+#endif
+
+/*
+ * One event queue per priority level. Bit n of ready is set when
+ * level n has queued events. The total over all levels may not fit in
+ * a process_num_events_t.
+ */
+static unsigned short nevents;
+static process_num_events_t queued[PROCESS_PRIORITIES], fevent[PROCESS_PRIORITIES];
+static struct event_data events[PROCESS_PRIORITIES][PROCESS_CONF_NUMEVENTS];
+static unsigned char ready;
 
 #if PROCESS_CONF_STATS
-process_num_events_t process_maxevents;
+unsigned short process_maxevents;
 #endif
 
-static volatile unsigned char poll_requested;
+/* Set from interrupts, hence one flag per level rather than a bitmap */
+static volatile unsigned char poll_requested[PROCESS_PRIORITIES];
+
+#if PROCESS_PRIORITIES > 1
+/* Set when process_set_priority() re-links the process list */
+static unsigned char list_changed;
+#define PRIORITY(p) ((p)->priority)
+#else
+#define PRIORITY(p) PROCESS_PRIORITY_NORMAL
+#endif
 
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
@@ -95,6 +115,38 @@ process_alloc_event(void)
   return lastevent++;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * The process list is ordered by decreasing priority. A process is
+ * put first among the processes of its own priority.
+ */
+static void
+insert_process(struct process *p)
+{
+  struct process **q;
+
+  for(q = &process_list; *q != NULL && PRIORITY(*q) > PRIORITY(p);
+      q = &(*q)->next);
+  p->next = *q;
+  *q = p;
+}
+/*---------------------------------------------------------------------------*/
+static int
+polls_pending(void)
+{
+#if PROCESS_PRIORITIES > 1
+  int level;
+
+  for(level = 0; level < PROCESS_PRIORITIES; level++) {
+    if(poll_requested[level]) {
+      return 1;
+    }
+  }
+  return 0;
+#else
+  return poll_requested[0];
+#endif
+}
+/*---------------------------------------------------------------------------*/
 void
 process_start(struct process *p, process_data_t data)
 {
@@ -109,8 +161,7 @@ process_start(struct process *p, process_data_t data)
     return;
   }
   /* Put on the procs list.*/
-  p->next = process_list;
-  process_list = p;
+  insert_process(p);
   p->state = PROCESS_STATE_RUNNING;
   PT_INIT(&p->pt);
 
@@ -187,6 +238,13 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if PROCESS_CONF_COUNTERS
+    if(ev == PROCESS_EVENT_POLL) {
+      p->npolls++;
+    } else {
+      p->nevents++;
+    }
+#endif /* PROCESS_CONF_COUNTERS */
     ret = p->thread(&p->pt, ev, data);
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
@@ -205,11 +263,43 @@ process_exit(struct process *p)
 }
 /*---------------------------------------------------------------------------*/
 void
+process_set_priority(struct process *p, unsigned char priority)
+{
+#if PROCESS_PRIORITIES > 1
+  struct process **q;
+
+  if(priority > PROCESS_PRIORITY_HIGH) {
+    priority = PROCESS_PRIORITY_HIGH;
+  }
+
+  /* Move a started process to its new position in the list */
+  for(q = &process_list; *q != NULL && *q != p; q = &(*q)->next);
+  if(*q == p) {
+    *q = p->next;
+    p->priority = priority;
+    insert_process(p);
+    list_changed = 1;
+  } else {
+    p->priority = priority;
+  }
+  if(p->needspoll) {
+    poll_requested[priority] = 1;
+  }
+#endif /* PROCESS_PRIORITIES > 1 */
+}
+/*---------------------------------------------------------------------------*/
+void
 process_init(void)
 {
+  int level;
+
   lastevent = PROCESS_EVENT_MAX;
 
-  nevents = fevent = 0;
+  nevents = 0;
+  ready = 0;
+  for(level = 0; level < PROCESS_PRIORITIES; level++) {
+    queued[level] = fevent[level] = 0;
+  }
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
@@ -225,14 +315,32 @@ static void
 do_poll(void)
 {
   struct process *p;
+  int level, i;
+
+  /* Find the lowest level with polls requested. The process list is
+     ordered by priority, so the processes below it are not visited. */
+  for(level = 0; level < PROCESS_PRIORITY_HIGH && !poll_requested[level]; level++);
+  for(i = level; i < PROCESS_PRIORITIES; i++) {
+    poll_requested[i] = 0;
+  }
 
-  poll_requested = 0;
   /* Call the processes that needs to be polled. */
-  for(p = process_list; p != NULL; p = p->next) {
+#if PROCESS_PRIORITIES > 1
+  list_changed = 0;
+#endif /* PROCESS_PRIORITIES > 1 */
+  for(p = process_list; p != NULL && PRIORITY(p) >= level; p = p->next) {
     if(p->needspoll) {
       p->state = PROCESS_STATE_RUNNING;
       p->needspoll = 0;
       call_process(p, PROCESS_EVENT_POLL, NULL);
+#if PROCESS_PRIORITIES > 1
+      if(list_changed) {
+        /* A poll handler changed a priority, so p->next may skip
+           processes. Leave the remaining ones to the next round. */
+        poll_requested[level] = 1;
+        break;
+      }
+#endif /* PROCESS_PRIORITIES > 1 */
     }
   }
 }
@@ -249,7 +357,9 @@ do_event(void)
   process_data_t data;
   struct process *receiver;
   struct process *p;
-  
+  struct event_data *e;
+  int level;
+
   /*
    * If there are any events in the queue, take the first one and walk
    * through the list of processes to see if the event should be
@@ -259,16 +369,22 @@ do_event(void)
    */
 
   if(nevents > 0) {
-    
-    /* There are events that we should deliver. */
-    ev = events[fevent].ev;
-    
-    data = events[fevent].data;
-    receiver = events[fevent].p;
+
+    /* There are events that we should deliver. Take them from the
+       highest priority level that has any. */
+    for(level = PROCESS_PRIORITY_HIGH; level > 0 && !(ready & (1 << level));
+        level--);
+    e = &events[level][fevent[level]];
+    ev = e->ev;
+    data = e->data;
+    receiver = e->p;
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
-    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    fevent[level] = (fevent[level] + 1) % PROCESS_CONF_NUMEVENTS;
+    if(--queued[level] == 0) {
+      ready &= ~(1 << level);
+    }
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
@@ -278,7 +394,7 @@ do_event(void)
 
 	/* If we have been requested to poll a process, we do this in
 	   between processing the broadcast event. */
-	if(poll_requested) {
+	if(polls_pending()) {
 	  do_poll();
 	}
 	call_process(p, ev, data);
@@ -302,26 +418,28 @@ int
 process_run(void)
 {
   /* Process poll events. */
-  if(poll_requested) {
+  if(polls_pending()) {
     do_poll();
   }
 
   /* Process one event from the queue */
   do_event();
 
-  return nevents + poll_requested;
+  return nevents + polls_pending();
 }
 /*---------------------------------------------------------------------------*/
 int
 process_nevents(void)
 {
-  return nevents + poll_requested;
+  return nevents + polls_pending();
 }
 /*---------------------------------------------------------------------------*/
 int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
   process_num_events_t snum;
+  struct event_data *e;
+  int level;
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -332,7 +450,8 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
   
-  if(nevents == PROCESS_CONF_NUMEVENTS) {
+  level = p == PROCESS_BROADCAST ? PROCESS_PRIORITY_NORMAL : PRIORITY(p);
+  if(queued[level] == PROCESS_CONF_NUMEVENTS) {
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
@@ -343,10 +462,13 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
   
-  snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
-  events[snum].ev = ev;
-  events[snum].data = data;
-  events[snum].p = p;
+  snum = (process_num_events_t)(fevent[level] + queued[level]) % PROCESS_CONF_NUMEVENTS;
+  e = &events[level][snum];
+  e->ev = ev;
+  e->data = data;
+  e->p = p;
+  ++queued[level];
+  ready |= 1 << level;
   ++nevents;
 
 #if PROCESS_CONF_STATS
@@ -374,7 +496,7 @@ process_poll(struct process *p)
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
       p->needspoll = 1;
-      poll_requested = 1;
+      poll_requested[PRIORITY(p)] = 1;
     }
   }
 }
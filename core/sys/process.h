@@ -88,6 +88,34 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \name Process priorities
+ *
+ * With more than one priority level, each level has its own event
+ * queue of PROCESS_CONF_NUMEVENTS entries and the polls and events of
+ * higher priority processes are served first. Processes start at
+ * PROCESS_PRIORITY_NORMAL, see process_set_priority(). At most 8
+ * levels are supported.
+ * @{
+ */
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else
+#define PROCESS_PRIORITIES 1
+#endif /* PROCESS_CONF_PRIORITIES */
+
+#define PROCESS_PRIORITY_NORMAL 0
+#define PROCESS_PRIORITY_HIGH   (PROCESS_PRIORITIES - 1)
+/** @} */
+
+/**
+ * Count the events and polls delivered to each process, in the
+ * nevents and npolls fields of struct process.
+ */
+#ifndef PROCESS_CONF_COUNTERS
+#define PROCESS_CONF_COUNTERS 0
+#endif /* PROCESS_CONF_COUNTERS */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +351,12 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PRIORITIES > 1
+  unsigned char priority;
+#endif
+#if PROCESS_CONF_COUNTERS
+  unsigned short nevents, npolls;
+#endif
 };
 
 /**
@@ -389,6 +423,21 @@ CCIF void process_post_synch(struct process *p,
  */
 CCIF void process_exit(struct process *p);
 
+/**
+ * \brief      Set the scheduling priority of a process
+ * \param p    The process
+ * \param priority The priority, from PROCESS_PRIORITY_NORMAL to
+ *             PROCESS_PRIORITY_HIGH
+ *
+ *             This function can be called before or after the
+ *             process has been started. Events already queued for
+ *             the process are delivered at its previous priority. It
+ *             has no effect unless PROCESS_CONF_PRIORITIES is larger
+ *             than 1. When called from a poll handler, the processes
+ *             not polled yet are polled at the next round.
+ */
+void process_set_priority(struct process *p, unsigned char priority);
+
 
 /**
  * Get a pointer to the currently running process.
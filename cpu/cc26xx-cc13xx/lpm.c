@@ -283,8 +283,8 @@ check_next_etimer(rtimer_clock_t now, rtimer_clock_t *next_etimer, bool *next_et
 
   /* Find out the time of the next etimer */
   if(etimer_pending()) {
-    int32_t until_next_etimer = (int32_t)etimer_next_expiration_time() - (int32_t)clock_time();
-    if(until_next_etimer < 1) {
+    clock_time_t until_next_etimer = etimer_next_wakeup();
+    if(until_next_etimer == 0) {
       max_pm = MIN(max_pm, LPM_MODE_AWAKE);
     } else {
       *next_etimer_set = true;
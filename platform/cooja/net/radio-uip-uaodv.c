@@ -236,7 +236,18 @@ radio_uip_uaodv_send(void)
       
     return UIP_FW_DROPPED;
   }
-  
+
+  /* A route carrying traffic stays active, as does the one back to the
+     source (RFC 3561, section 6.2) */
+  uaodv_rt_lru(route);
+  if(tcpip_is_forwarding) {
+    struct uaodv_rt_entry *source;
+    source = uaodv_rt_lookup(&((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN])->srcipaddr);
+    if(source != NULL) {
+      uaodv_rt_lru(source);
+    }
+  }
+
   /* Add header and buffer packet for persistent transmission */
   uip_len = radio_uip_uaodv_add_header(&uip_buf[UIP_LLH_LEN], uip_len, uip_ds6_route_nexthop(route)); /* TODO Correct? */
   return radio_uip_buffer_outgoing_packet(
@@ -47,6 +47,9 @@
 #include "net/packetbuf.h"
 #include "net/rime/rimestats.h"
 #include "net/netstack.h"
+#if NETSTACK_CONF_WITH_IPV6
+#include "net/ip/tcpip.h"
+#endif /* NETSTACK_CONF_WITH_IPV6 */
 #include "net/mac/frame802154.h"
 #include "lib/crc16.h"
 #include "lib/ringbufindex.h"
@@ -867,6 +870,33 @@ radio_interrupt_handler(uint32 mac_event)
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Pass the oldest pending input packet to upper layer, if any */
+static int
+input_packet(void)
+{
+  int16_t read_index;
+
+  /* Access (without removing) a pending input packet */
+  read_index = ringbufindex_peek_get(&input_ringbuf);
+  if(read_index == -1) {
+    return 0;
+  }
+  input_frame_buffer = &input_array[read_index];
+  /* Put packet into packetbuf for input callback */
+  packetbuf_clear();
+  int len = read(packetbuf_dataptr(), PACKETBUF_SIZE);
+  /* is packet valid? */
+  if(len > 0) {
+    packetbuf_set_datalen(len);
+    NETSTACK_RDC.input();
+  }
+  /* Remove packet from ringbuf */
+  ringbufindex_get(&input_ringbuf);
+  /* Disable further read attempts */
+  input_frame_buffer->u8PayloadLength = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(micromac_radio_process, ev, data)
 {
   PROCESS_BEGIN();
@@ -875,23 +905,14 @@ PROCESS_THREAD(micromac_radio_process, ev, data)
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
 
     /* Pass received packets to upper layer */
-    int16_t read_index;
-    /* Loop on accessing (without removing) a pending input packet */
-    while((read_index = ringbufindex_peek_get(&input_ringbuf)) != -1) {
-      input_frame_buffer = &input_array[read_index];
-      /* Put packet into packetbuf for input callback */
-      packetbuf_clear();
-      int len = read(packetbuf_dataptr(), PACKETBUF_SIZE);
-      /* is packet valid? */
-      if(len > 0) {
-        packetbuf_set_datalen(len);
-        NETSTACK_RDC.input();
-      }
-      /* Remove packet from ringbuf */
-      ringbufindex_get(&input_ringbuf);
-      /* Disable further read attempts */
-      input_frame_buffer->u8PayloadLength = 0;
+#if NETSTACK_CONF_WITH_IPV6
+    if(tcpip_input_batch(input_packet) == TCPIP_INPUT_BATCH) {
+      /* More packets may be pending, let other processes run first */
+      process_poll(&micromac_radio_process);
     }
+#else /* NETSTACK_CONF_WITH_IPV6 */
+    while(input_packet());
+#endif /* NETSTACK_CONF_WITH_IPV6 */
 
     /* Are we recovering from overflow? */
     if(rx_frame_buffer == NULL) {
@@ -346,7 +346,7 @@ main(int argc, char **argv)
     clock_time_t next_event;
     
     n = process_run();
-    next_event = etimer_next_expiration_time() - clock_time();
+    next_event = etimer_next_wakeup();
 
 #if DEBUG_SLEEP
     if(n > 0)
@@ -78,6 +78,14 @@
 #define SELECT_MAX 8
 #endif
 
+/* Longest sleep in select(), in clock ticks. A process_poll() from
+   another thread is serviced within it. */
+#ifdef SELECT_CONF_MAX_WAIT
+#define SELECT_MAX_WAIT SELECT_CONF_MAX_WAIT
+#else
+#define SELECT_MAX_WAIT (CLOCK_SECOND / 100)
+#endif
+
 static const struct select_callback *select_callback[SELECT_MAX];
 static int select_max = 0;
 
@@ -256,12 +264,19 @@ main(int argc, char **argv)
     int maxfd;
     int i;
     int retval;
+    clock_time_t wakeup;
     struct timeval tv;
 
     retval = process_run();
 
-    tv.tv_sec = 0;
-    tv.tv_usec = retval ? 1 : 1000;
+    /* Sleep until the next timer expires, or an fd becomes ready, but
+       no longer than SELECT_MAX_WAIT */
+    wakeup = retval ? 0 : etimer_next_wakeup();
+    if(wakeup == ETIMER_NO_WAKEUP || wakeup > SELECT_MAX_WAIT) {
+      wakeup = SELECT_MAX_WAIT;
+    }
+    tv.tv_sec = wakeup / CLOCK_SECOND;
+    tv.tv_usec = (wakeup % CLOCK_SECOND) * (1000000 / CLOCK_SECOND);
 
     FD_ZERO(&fdr);
     FD_ZERO(&fdw);
@@ -69,6 +69,12 @@
 #undef TSCH_QUEUE_CONF_MAX_NEIGHBOR_QUEUES
 #define TSCH_QUEUE_CONF_MAX_NEIGHBOR_QUEUES 8
 
+#undef TSCH_SCHEDULE_CONF_WITH_INDEX
+#define TSCH_SCHEDULE_CONF_WITH_INDEX 1
+
+#undef TSCH_QUEUE_CONF_WITH_INDEX
+#define TSCH_QUEUE_CONF_WITH_INDEX 1
+
 /* The neighbor table size */
 #undef NBR_TABLE_CONF_MAX_NEIGHBORS
 #define NBR_TABLE_CONF_MAX_NEIGHBORS 8
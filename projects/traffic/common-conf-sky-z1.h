@@ -46,6 +46,9 @@
 #define UIP_CONF_BUFFER_SIZE   (64 + 0 + 48 + 70)
 #undef UIP_CONF_UDP_CONNS
 #define UIP_CONF_UDP_CONNS       1
+/* No RAM to spare for IPHC encodings */
+#undef SICSLOWPAN_CONF_IPHC_CACHE
+#define SICSLOWPAN_CONF_IPHC_CACHE 0
 
 /* The neighbor table size */
 #undef NBR_TABLE_CONF_MAX_NEIGHBORS
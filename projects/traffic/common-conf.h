@@ -79,10 +79,18 @@
 #undef UIP_CONF_UDP_CHECKSUMS
 #define UIP_CONF_UDP_CHECKSUMS   1
 
+/* 6LoWPAN: replay the IPHC encodings of the flows to the sinks */
+#undef SICSLOWPAN_CONF_IPHC_CACHE
+#define SICSLOWPAN_CONF_IPHC_CACHE 4
+
 /* Contiki netstack: MAC */
 #undef NETSTACK_CONF_MAC
 #define NETSTACK_CONF_MAC     csma_driver
 
+/* CSMA: send the packets queued to a neighbor as one ContikiMAC burst */
+#undef CSMA_CONF_WITH_BURST
+#define CSMA_CONF_WITH_BURST 1
+
 /* Contiki netstack: RDC */
 #undef NETSTACK_CONF_RDC
 #define NETSTACK_CONF_RDC     contikimac_driver
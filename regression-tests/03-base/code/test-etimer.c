@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "lib/random.h"
+
+PROCESS(test_process, "etimer.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define MAX_TIMERS 64
+#define BENCH_OPS 256
+
+static struct etimer timers[MAX_TIMERS];
+static struct etimer et_wait;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+stop_all(void)
+{
+  int i;
+
+  for(i = 0; i < MAX_TIMERS; i++) {
+    etimer_stop(&timers[i]);
+  }
+}
+
+/* The event timer library may have pending timers of its own, so the
+   next expiration must be no later than that of the test timers */
+static int
+next_not_after(int n)
+{
+  clock_time_t now, tdist, d;
+  int i, found;
+
+  now = clock_time();
+  tdist = 0;
+  found = 0;
+  for(i = 0; i < n; i++) {
+    if(!etimer_expired(&timers[i])) {
+      d = etimer_expiration_time(&timers[i]) - now;
+      if(!found || d < tdist) {
+        tdist = d;
+        found = 1;
+      }
+    }
+  }
+  if(!found) {
+    return 1;
+  }
+  return etimer_pending() &&
+    (clock_time_t)(etimer_next_expiration_time() - now) <= tdist;
+}
+
+UNIT_TEST_REGISTER(test_etimer_next, "Next expiration");
+UNIT_TEST(test_etimer_next)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  stop_all();
+  for(i = 0; i < MAX_TIMERS; i++) {
+    etimer_set(&timers[i], CLOCK_SECOND + random_rand() % (60 * CLOCK_SECOND));
+    UNIT_TEST_ASSERT(next_not_after(i + 1));
+  }
+
+  /* Re-arm and stop timers in random order */
+  for(i = 0; i < 4 * MAX_TIMERS; i++) {
+    if(random_rand() & 1) {
+      etimer_set(&timers[random_rand() % MAX_TIMERS],
+                 CLOCK_SECOND + random_rand() % (60 * CLOCK_SECOND));
+    } else {
+      etimer_stop(&timers[random_rand() % MAX_TIMERS]);
+    }
+    UNIT_TEST_ASSERT(next_not_after(MAX_TIMERS));
+  }
+
+  stop_all();
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_etimer_stop, "Stop");
+UNIT_TEST(test_etimer_stop)
+{
+  UNIT_TEST_BEGIN();
+
+  stop_all();
+  etimer_set(&timers[0], CLOCK_SECOND);
+  etimer_set(&timers[1], 2 * CLOCK_SECOND);
+  UNIT_TEST_ASSERT(!etimer_expired(&timers[0]) && !etimer_expired(&timers[1]));
+
+  etimer_stop(&timers[0]);
+  UNIT_TEST_ASSERT(etimer_expired(&timers[0]) && !etimer_expired(&timers[1]));
+  UNIT_TEST_ASSERT(next_not_after(2));
+
+  /* Stopping twice is harmless */
+  etimer_stop(&timers[0]);
+  UNIT_TEST_ASSERT(etimer_expired(&timers[0]) && !etimer_expired(&timers[1]));
+  UNIT_TEST_ASSERT(next_not_after(2));
+
+  etimer_stop(&timers[1]);
+  UNIT_TEST_ASSERT(etimer_expired(&timers[1]));
+
+  UNIT_TEST_END();
+}
+
+/* Timers are armed in reverse order and must fire by expiration time,
+   except for the stopped one */
+static int fire_order_ok;
+
+UNIT_TEST_REGISTER(test_etimer_order, "Expiration order");
+UNIT_TEST(test_etimer_order)
+{
+  UNIT_TEST_BEGIN();
+  UNIT_TEST_ASSERT(fire_order_ok);
+  UNIT_TEST_END();
+}
+
+/* A callback timer that expires after an event timer runs after its
+   event is delivered, even when both are due in the same poll. One that
+   sets itself again with no delay fires once per poll instead of
+   looping. */
+#define CALLBACKS 16
+static struct ctimer ct;
+static int callbacks, timer_delivered, callback_ok;
+
+static void
+callback(void *ptr)
+{
+  if(ptr != NULL && !timer_delivered) {
+    callback_ok = 0;
+  }
+  if(++callbacks < CALLBACKS) {
+    ctimer_set(&ct, 0, callback, NULL);
+  }
+}
+
+UNIT_TEST_REGISTER(test_ctimer, "Callback timers");
+UNIT_TEST(test_ctimer)
+{
+  UNIT_TEST_BEGIN();
+  UNIT_TEST_ASSERT(callback_ok);
+  UNIT_TEST_END();
+}
+
+static void
+bench(int n)
+{
+  rtimer_clock_t start, t_set, t_stop;
+  int i, k;
+
+  stop_all();
+  for(i = 0; i < n; i++) {
+    etimer_set(&timers[i], 10 * CLOCK_SECOND + random_rand() % (60 * CLOCK_SECOND));
+  }
+
+  /* Re-arm pending timers, as periodic processes do */
+  start = RTIMER_NOW();
+  for(k = 0; k < BENCH_OPS; k++) {
+    etimer_set(&timers[random_rand() % n],
+               10 * CLOCK_SECOND + random_rand() % (60 * CLOCK_SECOND));
+  }
+  t_set = RTIMER_NOW() - start;
+
+  /* Stop a pending timer and arm it again */
+  start = RTIMER_NOW();
+  for(k = 0; k < BENCH_OPS; k++) {
+    i = random_rand() % n;
+    etimer_stop(&timers[i]);
+    etimer_set(&timers[i], 10 * CLOCK_SECOND + random_rand() % (60 * CLOCK_SECOND));
+  }
+  t_stop = RTIMER_NOW() - start;
+
+  printf("etimer-bench: %d timers, %d ops, set %u stop+set %u rtimer ticks\n",
+         n, BENCH_OPS, (unsigned)t_set, (unsigned)t_stop);
+  stop_all();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int i, fired;
+  static clock_time_t last;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_etimer_next);
+  UNIT_TEST_RUN(test_etimer_stop);
+
+  stop_all();
+  for(i = 0; i < 8; i++) {
+    etimer_set(&timers[i], (8 - i) * CLOCK_SECOND / 8);
+  }
+  etimer_stop(&timers[3]);
+  fire_order_ok = 1;
+  last = 0;
+  for(fired = 0; fired < 7;) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(data == &timers[3] || etimer_expiration_time(data) < last) {
+      fire_order_ok = 0;
+    }
+    last = etimer_expiration_time(data);
+    fired++;
+  }
+  UNIT_TEST_RUN(test_etimer_order);
+
+  /* Both timers are already due, the event timer first */
+  etimer_set(&timers[0], 1);
+  etimer_adjust(&timers[0], -2);
+  ctimer_set(&ct, 0, callback, &ct);
+  timer_delivered = 0;
+  callbacks = 0;
+  callback_ok = 1;
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &timers[0]);
+  timer_delivered = 1;
+  /* The remaining callbacks take one poll each, and this process is
+     served in between */
+  process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
+  if(callbacks >= CALLBACKS) {
+    callback_ok = 0;
+  }
+  etimer_set(&et_wait, CLOCK_SECOND / 8);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et_wait));
+  if(callbacks != CALLBACKS) {
+    callback_ok = 0;
+  }
+  UNIT_TEST_RUN(test_ctimer);
+
+  for(i = 8; i <= MAX_TIMERS; i *= 2) {
+    bench(i);
+    /* Let the event timer process catch up between runs */
+    etimer_set(&et_wait, CLOCK_SECOND / 8);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et_wait));
+  }
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "net/ip/uip.h"
+#include "net/ip/tcpip.h"
+#include "net/rime/rime.h"
+#include "net/packetbuf.h"
+
+PROCESS(test_process, "IPHC cache test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+
+#define PAYLOAD_LEN 20
+#define FRAME_SIZE 64
+/* One flow more than the cache holds, so that they always miss */
+#define FLOWS (SICSLOWPAN_CONF_IPHC_CACHE + 1)
+
+#ifdef CONTIKI_TARGET_NATIVE
+#define BENCH_PACKETS 100000UL
+#else
+#define BENCH_PACKETS 500UL
+#endif
+
+static uint8_t frame[FRAME_SIZE];
+static uint16_t frame_len;
+static int sent;
+
+/* Frames sent for the same flow: first, again, with another checksum,
+   with another hop limit */
+static uint8_t frames[4][FRAME_SIZE];
+static uint16_t frames_len[4];
+/* Whether every flow got the same frame twice */
+static uint8_t flows_ok;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+sniff_input(void)
+{
+}
+
+/* Called by sicslowpan with the frame it just sent in packetbuf */
+static void
+sniff_output(int mac_status)
+{
+  frame_len = MIN(packetbuf_datalen(), FRAME_SIZE);
+  memcpy(frame, packetbuf_dataptr(), frame_len);
+  sent++;
+}
+RIME_SNIFFER(sniffer, sniff_input, sniff_output);
+
+/* Puts a UDP packet of the given flow in uip_buf and hands it to
+   sicslowpan, to the broadcast address */
+static void
+output(int flow, uint8_t ttl, uint16_t chksum)
+{
+  int i;
+
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[1] = UIP_UDPH_LEN + PAYLOAD_LEN;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = ttl;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0x100 + flow);
+  UIP_UDP_BUF->srcport = UIP_HTONS(5678);
+  UIP_UDP_BUF->destport = UIP_HTONS(5688 + flow);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  UIP_UDP_BUF->udpchksum = chksum;
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    uip_buf[UIP_LLIPH_LEN + UIP_UDPH_LEN + i] = i;
+  }
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN;
+
+  tcpip_output(NULL);
+}
+
+static int
+frame_cmp(int a, int b)
+{
+  return frames_len[a] == frames_len[b] &&
+    memcmp(frames[a], frames[b], frames_len[a]) == 0;
+}
+
+UNIT_TEST_REGISTER(test_iphc_replay, "Replayed encodings");
+UNIT_TEST(test_iphc_replay)
+{
+  int i, diff, pos;
+
+  UNIT_TEST_BEGIN();
+
+  /* The same headers give the same frame */
+  UNIT_TEST_ASSERT(frame_cmp(0, 1));
+
+  /* Only the checksum changes */
+  UNIT_TEST_ASSERT(frames_len[2] == frames_len[0]);
+  diff = 0;
+  pos = 0;
+  for(i = 0; i < frames_len[0]; i++) {
+    if(frames[2][i] != frames[0][i]) {
+      if(diff++ == 0) {
+        pos = i;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(diff > 0 && diff <= 2);
+  UNIT_TEST_ASSERT((frames[2][pos] == 0xab && frames[2][pos + 1] == 0xcd) ||
+                   (pos > 0 && frames[2][pos - 1] == 0xab && frames[2][pos] == 0xcd));
+
+  /* A hop limit of 63 is not compressed, unlike 64 */
+  UNIT_TEST_ASSERT(frames_len[3] == frames_len[0] + 1);
+
+  UNIT_TEST_ASSERT(flows_ok);
+
+  UNIT_TEST_END();
+}
+
+/* Sends packets without waiting for the MAC, as a busy router would */
+static void
+bench(int flows)
+{
+  rtimer_clock_t start, t;
+  unsigned long i;
+
+  start = RTIMER_NOW();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    output(i % flows, 64, 0x1234);
+  }
+  t = RTIMER_NOW() - start;
+
+  printf("iphc-bench: %d flows, %lu packets, %lu ns per packet\n",
+         flows, BENCH_PACKETS,
+         (unsigned long)((uint64_t)t * 1000000000UL / RTIMER_SECOND / BENCH_PACKETS));
+}
+
+#define OUTPUT_AND_WAIT(flow, ttl, chksum) do { \
+    sent = 0;                                    \
+    output(flow, ttl, chksum);                   \
+    while(sent == 0) {                           \
+      PROCESS_PAUSE();                           \
+    }                                            \
+  } while(0)
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int i, round;
+  static uint8_t first[FLOWS][FRAME_SIZE];
+  static uint16_t first_len[FLOWS];
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  rime_sniffer_add(&sniffer);
+
+  for(i = 0; i < 4; i++) {
+    OUTPUT_AND_WAIT(0, i == 3 ? 63 : 64, i == 2 ? UIP_HTONS(0xabcd) : 0x1234);
+    memcpy(frames[i], frame, frame_len);
+    frames_len[i] = frame_len;
+  }
+
+  /* More flows than cache entries: all frames must be computed again
+     the same way */
+  flows_ok = 1;
+  for(round = 0; round < 2; round++) {
+    for(i = 0; i < FLOWS; i++) {
+      OUTPUT_AND_WAIT(i, 64, 0x1234);
+      if(round == 0) {
+        memcpy(first[i], frame, frame_len);
+        first_len[i] = frame_len;
+      } else if(frame_len != first_len[i] ||
+                memcmp(first[i], frame, frame_len) != 0) {
+        flows_ok = 0;
+      }
+    }
+  }
+
+  UNIT_TEST_RUN(test_iphc_replay);
+
+  bench(1);
+  bench(FLOWS);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
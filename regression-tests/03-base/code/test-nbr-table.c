@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "lib/random.h"
+#include "net/nbr-table.h"
+
+PROCESS(test_process, "nbr-table.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Three times more addresses than neighbor entries, so that adding
+   often evicts an entry */
+#define ADDRESSES (3 * NBR_TABLE_MAX_NEIGHBORS)
+#define ROUNDS 2000
+
+struct test_nbr {
+  uint16_t id;
+};
+NBR_TABLE(struct test_nbr, test_nbrs);
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+lladdr(linkaddr_t *addr, int i)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->u8[0] = 0x02;
+  addr->u8[LINKADDR_SIZE - 2] = i >> 8;
+  addr->u8[LINKADDR_SIZE - 1] = i & 0xff;
+}
+
+/* Checks that looking up every address agrees with a walk of the table:
+ * every entry is found under its own address, and every address that is
+ * found leads to the entry holding it */
+static int
+consistent(void)
+{
+  linkaddr_t addr;
+  struct test_nbr *n, *found;
+  int i;
+
+  for(n = nbr_table_head(test_nbrs); n != NULL; n = nbr_table_next(test_nbrs, n)) {
+    if(nbr_table_get_from_lladdr(test_nbrs, nbr_table_get_lladdr(test_nbrs, n)) != n) {
+      return 0;
+    }
+  }
+  for(i = 0; i < ADDRESSES; i++) {
+    lladdr(&addr, i);
+    found = nbr_table_get_from_lladdr(test_nbrs, &addr);
+    if(found != NULL &&
+       (!linkaddr_cmp(&addr, nbr_table_get_lladdr(test_nbrs, found)) ||
+        found->id != i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void
+rm_all(void)
+{
+  struct test_nbr *n;
+
+  while((n = nbr_table_head(test_nbrs)) != NULL) {
+    nbr_table_remove(test_nbrs, n);
+  }
+}
+
+UNIT_TEST_REGISTER(test_nbr_basic, "Add, lookup and update");
+UNIT_TEST(test_nbr_basic)
+{
+  linkaddr_t addr, other;
+  struct test_nbr *n;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all();
+  lladdr(&addr, 1);
+  n = nbr_table_add_lladdr(test_nbrs, &addr, NBR_TABLE_REASON_UNDEFINED, NULL);
+  UNIT_TEST_ASSERT(n != NULL);
+  n->id = 1;
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &addr) == n);
+  lladdr(&other, 2);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &other) == NULL);
+
+  /* The entry moves to its new address */
+  UNIT_TEST_ASSERT(nbr_table_update_lladdr(&addr, &other, 0) == 1);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &addr) == NULL);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &other) == n);
+  UNIT_TEST_ASSERT(nbr_table_update_lladdr(&addr, &other, 0) == 0);
+
+  /* A duplicate address removes the old entry if asked to */
+  n = nbr_table_add_lladdr(test_nbrs, &addr, NBR_TABLE_REASON_UNDEFINED, NULL);
+  UNIT_TEST_ASSERT(n != NULL);
+  UNIT_TEST_ASSERT(nbr_table_update_lladdr(&addr, &other, 1) == 0);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &addr) == NULL);
+  UNIT_TEST_ASSERT(nbr_table_get_from_lladdr(test_nbrs, &other) != NULL);
+
+  rm_all();
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_nbr_churn, "Lookups under churn");
+UNIT_TEST(test_nbr_churn)
+{
+  linkaddr_t addr, other;
+  struct test_nbr *n;
+  int i, a, b;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all();
+  for(i = 0; i < ROUNDS; i++) {
+    a = random_rand() % ADDRESSES;
+    lladdr(&addr, a);
+    switch(random_rand() % 4) {
+    case 0:
+    case 1:
+      /* Evicts the oldest entry once the table is full */
+      n = nbr_table_add_lladdr(test_nbrs, &addr, NBR_TABLE_REASON_UNDEFINED, NULL);
+      if(n != NULL) {
+        n->id = a;
+      }
+      break;
+    case 2:
+      n = nbr_table_get_from_lladdr(test_nbrs, &addr);
+      if(n != NULL) {
+        nbr_table_remove(test_nbrs, n);
+      }
+      break;
+    default:
+      b = random_rand() % ADDRESSES;
+      lladdr(&other, b);
+      n = nbr_table_get_from_lladdr(test_nbrs, &addr);
+      if(nbr_table_update_lladdr(&addr, &other, 0) && n != NULL) {
+        n->id = b;
+      }
+      break;
+    }
+    UNIT_TEST_ASSERT(consistent());
+  }
+
+  rm_all();
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  nbr_table_register(test_nbrs, NULL);
+
+  UNIT_TEST_RUN(test_nbr_basic);
+  UNIT_TEST_RUN(test_nbr_churn);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
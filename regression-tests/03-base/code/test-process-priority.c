@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026, Contiki contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+PROCESS(test_process, "Process priority test");
+PROCESS(normal_process, "Normal priority process");
+PROCESS(high_process, "High priority process");
+PROCESS(first_process, "First polled process");
+PROCESS(second_process, "Second polled process");
+AUTOSTART_PROCESSES(&test_process);
+
+static process_event_t test_event;
+static int posted, normal_received, high_received_after = -1;
+/* Dispatches of the poll test: f and s for the polls of first_process
+   and second_process, t for the test process */
+static char order[8];
+static int norder;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(normal_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == test_event);
+    if(++normal_received == posted) {
+      process_post(&test_process, test_event, NULL);
+    }
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(high_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == test_event);
+    high_received_after = normal_received;
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Polled ahead of second_process, and lowers its own priority when it is */
+PROCESS_THREAD(first_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    order[norder++] = 'f';
+    process_set_priority(&first_process, PROCESS_PRIORITY_NORMAL);
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(second_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    order[norder++] = 's';
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_full_queue, "High priority events ahead of a full queue");
+UNIT_TEST(test_full_queue)
+{
+  UNIT_TEST_BEGIN();
+  /* Built with PROCESS_CONF_PRIORITIES=2 */
+  UNIT_TEST_ASSERT(PROCESS_PRIORITIES > 1);
+  UNIT_TEST_ASSERT(posted > 0);
+  UNIT_TEST_ASSERT(normal_received == posted);
+  UNIT_TEST_ASSERT(high_received_after == 0);
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_poll_priority, "Priority change in a poll handler");
+UNIT_TEST(test_poll_priority)
+{
+  UNIT_TEST_BEGIN();
+  UNIT_TEST_ASSERT(strcmp(order, "ftst") == 0);
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  test_event = process_alloc_event();
+  process_set_priority(&high_process, PROCESS_PRIORITY_HIGH);
+  process_start(&normal_process, NULL);
+  process_start(&high_process, NULL);
+  /* Second first, as a process is put ahead of those of its priority */
+  process_set_priority(&second_process, PROCESS_PRIORITY_HIGH);
+  process_set_priority(&first_process, PROCESS_PRIORITY_HIGH);
+  process_start(&second_process, NULL);
+  process_start(&first_process, NULL);
+  PROCESS_PAUSE();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Fill the normal priority queue, then post at high priority */
+  while(process_post(&normal_process, test_event, NULL) == PROCESS_ERR_OK) {
+    posted++;
+  }
+  if(process_post(&high_process, test_event, NULL) != PROCESS_ERR_OK) {
+    high_received_after = posted + 1;
+  }
+  PROCESS_WAIT_EVENT_UNTIL(ev == test_event);
+  UNIT_TEST_RUN(test_full_queue);
+
+  /* Lowering first_process in its poll handler re-links the process
+     list while it is walked. The poll of second_process is left to the
+     next round, not lost: it comes before the second event here. */
+  process_poll(&first_process);
+  process_poll(&second_process);
+  PROCESS_PAUSE();
+  order[norder++] = 't';
+  PROCESS_PAUSE();
+  order[norder++] = 't';
+  UNIT_TEST_RUN(test_poll_priority);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
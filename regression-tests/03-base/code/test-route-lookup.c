@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "lib/random.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+
+PROCESS(test_process, "uip-ds6-route.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NEXTHOPS 4
+#define BENCH_LOOKUPS 256
+
+static uip_ipaddr_t nexthops[NEXTHOPS];
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+add_nexthops(void)
+{
+  uip_lladdr_t lladdr;
+  int i;
+
+  for(i = 0; i < NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[0] = 0x02;
+    lladdr.addr[sizeof(lladdr) - 1] = i + 1;
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_set_addr_iid(&nexthops[i], &lladdr);
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+}
+
+static void
+rm_all_routes(void)
+{
+  while(uip_ds6_route_head() != NULL) {
+    uip_ds6_route_rm(uip_ds6_route_head());
+  }
+}
+
+static void
+host(uip_ipaddr_t *addr, int i)
+{
+  uip_ip6addr(addr, 0xaaaa, 0, 0, 0, 0x0212, 0x7400, i >> 8, i & 0xff);
+}
+
+UNIT_TEST_REGISTER(test_route_lookup, "Longest prefix match");
+UNIT_TEST(test_route_lookup)
+{
+  uip_ipaddr_t addr, prefix;
+  uip_ds6_route_t *r48, *r64, *rhost;
+
+  UNIT_TEST_BEGIN();
+
+  /* uip_ds6_route_add() replaces the route matching the new
+     destination, so add the most specific routes first, and give the
+     /48 an address outside the /64 */
+  rm_all_routes();
+  host(&addr, 1);
+  rhost = uip_ds6_route_add(&addr, 128, &nexthops[2]);
+  uip_ip6addr(&prefix, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  r64 = uip_ds6_route_add(&prefix, 64, &nexthops[1]);
+  uip_ip6addr(&prefix, 0xaaaa, 0, 0, 0xffff, 0, 0, 0, 0);
+  r48 = uip_ds6_route_add(&prefix, 48, &nexthops[0]);
+  UNIT_TEST_ASSERT(r48 != NULL && r64 != NULL && rhost != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 3);
+
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == rhost);
+  host(&addr, 2);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r64);
+  uip_ip6addr(&addr, 0xaaaa, 0, 0, 1, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r48);
+  uip_ip6addr(&addr, 0xbbbb, 0, 0, 0, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  /* Falls back to the next longest prefix once removed */
+  uip_ds6_route_rm(r64);
+  host(&addr, 2);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r48);
+  uip_ds6_route_rm(rhost);
+  host(&addr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r48);
+
+  rm_all_routes();
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_route_nexthop, "Routes per next hop");
+UNIT_TEST(test_route_nexthop)
+{
+  uip_ipaddr_t addr;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all_routes();
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    host(&addr, i);
+    UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &nexthops[i % NEXTHOPS]) != NULL);
+  }
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB);
+
+  /* Removing a next hop removes all its routes from the index too */
+  uip_ds6_route_rm_by_nexthop(&nexthops[0]);
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    host(&addr, i);
+    if(i % NEXTHOPS == 0) {
+      UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+    } else {
+      UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) != NULL);
+      UNIT_TEST_ASSERT(uip_ipaddr_cmp(uip_ds6_route_nexthop(uip_ds6_route_lookup(&addr)),
+                                      &nexthops[i % NEXTHOPS]));
+    }
+  }
+  UNIT_TEST_ASSERT(!uip_ds6_route_is_nexthop(&nexthops[0]));
+  UNIT_TEST_ASSERT(uip_ds6_route_is_nexthop(&nexthops[1]));
+
+  rm_all_routes();
+
+  UNIT_TEST_END();
+}
+
+#if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+UNIT_TEST_REGISTER(test_route_lru, "Least recently used replacement");
+UNIT_TEST(test_route_lru)
+{
+  uip_ipaddr_t addr;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all_routes();
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    host(&addr, i);
+    uip_ds6_route_add(&addr, 128, &nexthops[i % NEXTHOPS]);
+  }
+  /* Use every route but the second one */
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    if(i != 1) {
+      host(&addr, i);
+      uip_ds6_route_lookup(&addr);
+    }
+  }
+  host(&addr, UIP_DS6_ROUTE_NB);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &nexthops[0]) != NULL);
+  host(&addr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+  host(&addr, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) != NULL);
+
+  rm_all_routes();
+
+  UNIT_TEST_END();
+}
+
+/* Recency is kept in 16-bit lookup sequence numbers. A route left idle
+   for as many lookups must not look recently used again. */
+UNIT_TEST_REGISTER(test_route_lru_wrap, "LRU replacement after 65536 lookups");
+UNIT_TEST(test_route_lru_wrap)
+{
+  uip_ipaddr_t addr;
+  uint32_t i;
+
+  UNIT_TEST_BEGIN();
+
+  rm_all_routes();
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    host(&addr, i);
+    uip_ds6_route_add(&addr, 128, &nexthops[i % NEXTHOPS]);
+  }
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    if(i != 1) {
+      host(&addr, i);
+      uip_ds6_route_lookup(&addr);
+    }
+  }
+  /* Without clamping, the idle second route would now be the newest */
+  host(&addr, 0);
+  for(i = 0; i < 65536UL - 2 * UIP_DS6_ROUTE_NB + 3; i++) {
+    uip_ds6_route_lookup(&addr);
+  }
+  for(i = 2; i < UIP_DS6_ROUTE_NB; i++) {
+    host(&addr, i);
+    uip_ds6_route_lookup(&addr);
+  }
+  host(&addr, UIP_DS6_ROUTE_NB);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &nexthops[0]) != NULL);
+  host(&addr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  rm_all_routes();
+
+  UNIT_TEST_END();
+}
+#endif /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
+
+static void
+bench(int n)
+{
+  uip_ipaddr_t addr;
+  rtimer_clock_t start, t;
+  int i;
+
+  rm_all_routes();
+  for(i = 0; i < n; i++) {
+    host(&addr, i);
+    uip_ds6_route_add(&addr, 128, &nexthops[i % NEXTHOPS]);
+  }
+
+  /* Destinations spread over the whole table, as at a root */
+  start = RTIMER_NOW();
+  for(i = 0; i < BENCH_LOOKUPS; i++) {
+    host(&addr, random_rand() % n);
+    uip_ds6_route_lookup(&addr);
+  }
+  t = RTIMER_NOW() - start;
+
+  printf("route-bench: %d routes, %d lookups, %u rtimer ticks\n",
+         n, BENCH_LOOKUPS, (unsigned)t);
+  rm_all_routes();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  int n;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  add_nexthops();
+
+  UNIT_TEST_RUN(test_route_lookup);
+  UNIT_TEST_RUN(test_route_nexthop);
+#if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  UNIT_TEST_RUN(test_route_lru);
+  UNIT_TEST_RUN(test_route_lru_wrap);
+#endif /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
+
+  for(n = 4; n <= UIP_DS6_ROUTE_NB; n *= 2) {
+    bench(n);
+  }
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
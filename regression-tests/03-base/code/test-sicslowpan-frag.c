@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/rime/rime.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+
+PROCESS(test_process, "sicslowpan.c fragmentation test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+/* Datagrams of three fragments: the first one carries the IPv6 and UDP
+   headers, offsets of the others are multiples of 8 */
+#define DATAGRAM_SIZE 200
+#define FIRST_SIZE 104
+#define FRAGN_SIZE 48
+#define DATAGRAMS 4
+
+static uint8_t datagrams[DATAGRAMS][DATAGRAM_SIZE];
+static uint8_t received[DATAGRAMS];
+static int received_other;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/* Called by sicslowpan with each complete datagram in uip_buf */
+static void
+sniff_input(void)
+{
+  int i;
+
+  for(i = 0; i < DATAGRAMS; i++) {
+    if(uip_len == DATAGRAM_SIZE &&
+       memcmp(UIP_IP_BUF, datagrams[i], DATAGRAM_SIZE) == 0) {
+      received[i]++;
+      return;
+    }
+  }
+  received_other++;
+}
+static void
+sniff_output(int mac_status)
+{
+}
+RIME_SNIFFER(sniffer, sniff_input, sniff_output);
+
+static void
+lladdr(linkaddr_t *addr, int i)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->u8[0] = 0x02;
+  addr->u8[LINKADDR_SIZE - 1] = i;
+}
+
+static void
+dest_ipaddr(uip_ipaddr_t *addr)
+{
+  uip_ip6addr(addr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0xd);
+}
+
+static void
+make_datagram(int i)
+{
+  struct uip_ip_hdr *ip = (struct uip_ip_hdr *)datagrams[i];
+  struct uip_udp_hdr *udp = (struct uip_udp_hdr *)&datagrams[i][UIP_IPH_LEN];
+  int j;
+
+  memset(ip, 0, UIP_IPH_LEN);
+  ip->vtc = 0x60;
+  ip->len[0] = (DATAGRAM_SIZE - UIP_IPH_LEN) >> 8;
+  ip->len[1] = (DATAGRAM_SIZE - UIP_IPH_LEN) & 0xff;
+  ip->proto = UIP_PROTO_UDP;
+  ip->ttl = 64;
+  uip_ip6addr(&ip->srcipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0x10 + i);
+  dest_ipaddr(&ip->destipaddr);
+  udp->srcport = UIP_HTONS(1000 + i);
+  udp->destport = UIP_HTONS(2000);
+  udp->udplen = UIP_HTONS(DATAGRAM_SIZE - UIP_IPH_LEN);
+  udp->udpchksum = 0;
+  for(j = UIP_IPH_LEN + UIP_UDPH_LEN; j < DATAGRAM_SIZE; j++) {
+    datagrams[i][j] = i * 37 + j;
+  }
+  received[i] = 0;
+}
+
+/* Feeds the fragment of datagram i at the given offset, as sent by
+   sender with the given tag, to sicslowpan */
+static void
+input_fragment(int i, int sender, uint16_t tag, uint16_t offset)
+{
+  linkaddr_t addr;
+  uint8_t *frame;
+  uint16_t len;
+
+  packetbuf_clear();
+  frame = packetbuf_dataptr();
+  if(offset == 0) {
+    frame[0] = SICSLOWPAN_DISPATCH_FRAG1 | (DATAGRAM_SIZE >> 8);
+    frame[4] = SICSLOWPAN_DISPATCH_IPV6;
+    len = FIRST_SIZE;
+  } else {
+    frame[0] = SICSLOWPAN_DISPATCH_FRAGN | (DATAGRAM_SIZE >> 8);
+    frame[4] = offset >> 3;
+    len = MIN(FRAGN_SIZE, DATAGRAM_SIZE - offset);
+  }
+  frame[1] = DATAGRAM_SIZE & 0xff;
+  frame[2] = tag >> 8;
+  frame[3] = tag & 0xff;
+  memcpy(&frame[5], &datagrams[i][offset], len);
+  packetbuf_set_datalen(5 + len);
+
+  lladdr(&addr, sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+
+UNIT_TEST_REGISTER(test_frag_reassembly, "Interleaved reassembly");
+UNIT_TEST(test_frag_reassembly)
+{
+  uint16_t offset;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < DATAGRAMS; i++) {
+    make_datagram(i);
+  }
+  received_other = 0;
+
+  /* Senders share the same tag, the last one sends twice */
+  for(i = 0; i < DATAGRAMS; i++) {
+    input_fragment(i, i == DATAGRAMS - 1 ? 1 : i + 1,
+                   i == DATAGRAMS - 1 ? 8 : 7, 0);
+  }
+  /* The other fragments of all datagrams, last ones first */
+  for(offset = DATAGRAM_SIZE - FRAGN_SIZE; offset >= FIRST_SIZE;
+      offset -= FRAGN_SIZE) {
+    for(i = DATAGRAMS - 1; i >= 0; i--) {
+      input_fragment(i, i == DATAGRAMS - 1 ? 1 : i + 1,
+                     i == DATAGRAMS - 1 ? 8 : 7, offset);
+    }
+  }
+
+  for(i = 0; i < DATAGRAMS; i++) {
+    UNIT_TEST_ASSERT(received[i] == 1);
+  }
+  UNIT_TEST_ASSERT(received_other == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_frag_forward, "Fragment forwarding");
+UNIT_TEST(test_frag_forward)
+{
+  uip_ipaddr_t dest, nexthop;
+  uip_lladdr_t nexthop_lladdr;
+  uip_ds6_route_t *route;
+  uint16_t offset;
+
+  UNIT_TEST_BEGIN();
+
+  make_datagram(0);
+  make_datagram(1);
+  received_other = 0;
+
+  /* A route to the destination through a known neighbor */
+  dest_ipaddr(&dest);
+  uip_ip6addr(&nexthop, 0xfe80, 0, 0, 0, 0, 0, 0, 0x20);
+  lladdr((linkaddr_t *)&nexthop_lladdr, 0x20);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_add(&nexthop, &nexthop_lladdr, 1, NBR_REACHABLE,
+                                   NBR_TABLE_REASON_UNDEFINED, NULL) != NULL);
+  route = uip_ds6_route_add(&dest, 128, &nexthop);
+  UNIT_TEST_ASSERT(route != NULL);
+
+  /* Relayed as the fragments arrive, not reassembled */
+  for(offset = 0; offset < DATAGRAM_SIZE;
+      offset += offset == 0 ? FIRST_SIZE : FRAGN_SIZE) {
+    input_fragment(0, 1, 9, offset);
+  }
+  UNIT_TEST_ASSERT(received[0] == 0);
+
+  /* Without a route the datagram is reassembled */
+  uip_ds6_route_rm(route);
+  for(offset = 0; offset < DATAGRAM_SIZE;
+      offset += offset == 0 ? FIRST_SIZE : FRAGN_SIZE) {
+    input_fragment(1, 1, 10, offset);
+  }
+  UNIT_TEST_ASSERT(received[1] == 1);
+  UNIT_TEST_ASSERT(received_other == 0);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  rime_sniffer_add(&sniffer);
+
+  UNIT_TEST_RUN(test_frag_reassembly);
+  UNIT_TEST_RUN(test_frag_forward);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "net/ip/uip.h"
+#include "net/ip/tcpip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+
+PROCESS(test_process, "tcpip.c batch input test");
+PROCESS(receiver_process, "UDP receiver");
+AUTOSTART_PROCESSES(&test_process, &receiver_process);
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+
+#define PORT 5678
+#define PAYLOAD_LEN 20
+#define QUEUED 10
+
+#ifdef CONTIKI_TARGET_NATIVE
+#define BENCH_FRAMES 100000UL
+#else
+#define BENCH_FRAMES 500UL
+#endif
+
+/* A received frame, as a radio driver would have it queued */
+static uint8_t frame[1 + UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN];
+static int queued;
+static int received;
+static struct process *received_in;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/* A UDP datagram to our link-local address, behind the IPv6 dispatch */
+static void
+make_frame(void)
+{
+  int i;
+
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[1] = UIP_UDPH_LEN + PAYLOAD_LEN;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &uip_ds6_get_link_local(-1)->ipaddr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(PORT);
+  UIP_UDP_BUF->destport = UIP_HTONS(PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    uip_buf[UIP_LLIPH_LEN + UIP_UDPH_LEN + i] = i;
+  }
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN;
+  UIP_UDP_BUF->udpchksum = 0;
+  UIP_UDP_BUF->udpchksum = ~(uip_udpchksum());
+
+  frame[0] = SICSLOWPAN_DISPATCH_IPV6;
+  memcpy(&frame[1], UIP_IP_BUF, uip_len);
+  uip_clear_buf();
+}
+
+/* Passes one of the queued frames to the network stack */
+static int
+input_frame(void)
+{
+  linkaddr_t sender;
+
+  if(queued == 0) {
+    return 0;
+  }
+  queued--;
+
+  packetbuf_clear();
+  memcpy(packetbuf_dataptr(), frame, sizeof(frame));
+  packetbuf_set_datalen(sizeof(frame));
+  memset(&sender, 0, sizeof(sender));
+  sender.u8[LINKADDR_SIZE - 1] = 1;
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+  return 1;
+}
+
+UNIT_TEST_REGISTER(test_batch_input, "Batched input");
+UNIT_TEST(test_batch_input)
+{
+  int n;
+
+  UNIT_TEST_BEGIN();
+
+  queued = QUEUED;
+  received = 0;
+  received_in = NULL;
+
+  /* Full batches, then what is left */
+  n = tcpip_input_batch(input_frame);
+  UNIT_TEST_ASSERT(n == MIN(TCPIP_INPUT_BATCH, QUEUED));
+  UNIT_TEST_ASSERT(queued == QUEUED - n);
+  UNIT_TEST_ASSERT(received == n);
+  while(queued > 0) {
+    UNIT_TEST_ASSERT(tcpip_input_batch(input_frame) > 0);
+  }
+  UNIT_TEST_ASSERT(tcpip_input_batch(input_frame) == 0);
+  UNIT_TEST_ASSERT(received == QUEUED);
+
+  /* Applications are called as for single packets */
+  UNIT_TEST_ASSERT(received_in == &receiver_process);
+
+  /* Single packets still go through */
+  queued = 1;
+  UNIT_TEST_ASSERT(input_frame() == 1);
+  UNIT_TEST_ASSERT(received == QUEUED + 1);
+
+  UNIT_TEST_END();
+}
+
+static void
+bench(int batch)
+{
+  rtimer_clock_t start, t;
+
+  queued = BENCH_FRAMES;
+  received = 0;
+  start = RTIMER_NOW();
+  if(batch) {
+    while(tcpip_input_batch(input_frame) > 0);
+  } else {
+    while(input_frame());
+  }
+  t = RTIMER_NOW() - start;
+
+  printf("tcpip-bench: %s, %d frames received, %lu ns per frame\n",
+         batch ? "batched" : "single", received,
+         (unsigned long)((uint64_t)t * 1000000000UL / RTIMER_SECOND / BENCH_FRAMES));
+}
+
+PROCESS_THREAD(receiver_process, ev, data)
+{
+  static struct uip_udp_conn *conn;
+
+  PROCESS_BEGIN();
+
+  conn = udp_new(NULL, 0, NULL);
+  udp_bind(conn, UIP_HTONS(PORT));
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == tcpip_event && uip_newdata()) {
+      received++;
+      received_in = PROCESS_CURRENT();
+    }
+  }
+
+  PROCESS_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Let the receiver bind its port */
+  PROCESS_PAUSE();
+  make_frame();
+
+  UNIT_TEST_RUN(test_batch_input);
+
+  bench(0);
+  bench(1);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
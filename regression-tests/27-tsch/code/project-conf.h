@@ -38,11 +38,17 @@
 #undef QUEUEBUF_CONF_NUM
 #define QUEUEBUF_CONF_NUM   1
 
-#undef TSCH_LOG_CONF_LEVEL
+/* The schedule_index test builds with TSCH_LOG_CONF_LEVEL=0, as the
+ * schedule changes it makes would overflow the Cooja log buffer */
+#ifndef TSCH_LOG_CONF_LEVEL
 #define TSCH_LOG_CONF_LEVEL 2
+#endif /* TSCH_LOG_CONF_LEVEL */
 
-#undef TSCH_CONF_AUTOSTART
+/* The orchestra_traffic test builds with TSCH_CONF_AUTOSTART=0, so that
+ * its timers are not held up by the association scan */
+#ifndef TSCH_CONF_AUTOSTART
 #define TSCH_CONF_AUTOSTART 1
+#endif /* TSCH_CONF_AUTOSTART */
 
 #undef NETSTACK_CONF_MAC
 #define NETSTACK_CONF_MAC        tschmac_driver
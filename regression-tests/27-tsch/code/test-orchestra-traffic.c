@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/linkaddr.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "orchestra.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "Orchestra traffic-aware rule test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define SLOTFRAME_HANDLE 3
+/* As in the rule */
+#define STRIDE ((ORCHESTRA_TRAFFIC_PERIOD / ORCHESTRA_TRAFFIC_MAX_CELLS) > 0 ? \
+                (ORCHESTRA_TRAFFIC_PERIOD / ORCHESTRA_TRAFFIC_MAX_CELLS) : 1)
+
+static linkaddr_t parent_addr;
+static linkaddr_t child_addr;
+static uip_ds6_route_t *child_route;
+static struct tsch_slotframe *sf;
+
+/*---------------------------------------------------------------------------*/
+/* Whether a node listens at the timeslot when it has children */
+static int
+listens_at(const linkaddr_t *addr, uint16_t timeslot)
+{
+  int k;
+
+  for(k = 0; k < ORCHESTRA_TRAFFIC_MAX_CELLS; k++) {
+    if((ORCHESTRA_LINKADDR_HASH(addr) + k * STRIDE) % ORCHESTRA_TRAFFIC_PERIOD == timeslot) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+count_links(uint8_t option)
+{
+  struct tsch_link *l;
+  int count = 0;
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options & option) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Select a packet to the parent, returns the rule's answer */
+static int
+select_to_parent(uint8_t proto, uint16_t *slotframe, uint16_t *timeslot)
+{
+  packetbuf_clear();
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &parent_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, proto);
+  *slotframe = SLOTFRAME_HANDLE;
+  *timeslot = 0;
+  return unicast_traffic_aware.select_packet(slotframe, timeslot);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(rx, "Nodes with a child listen at all their cells");
+UNIT_TEST(rx)
+{
+  uip_ipaddr_t child_ipaddr, dest_ipaddr;
+  struct tsch_link *l;
+
+  UNIT_TEST_BEGIN();
+
+  unicast_traffic_aware.init(SLOTFRAME_HANDLE);
+  sf = tsch_schedule_get_slotframe_by_handle(SLOTFRAME_HANDLE);
+  UNIT_TEST_ASSERT(sf != NULL);
+  UNIT_TEST_ASSERT(list_head(sf->links_list) == NULL);
+
+  /* A child with a route through it */
+  uip_create_linklocal_prefix(&child_ipaddr);
+  uip_ds6_set_addr_iid(&child_ipaddr, (uip_lladdr_t *)&child_addr);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_add(&child_ipaddr, (uip_lladdr_t *)&child_addr, 1,
+                                   NBR_REACHABLE, NBR_TABLE_REASON_UNDEFINED, NULL) != NULL);
+  uip_ip6addr(&dest_ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 0x10);
+  child_route = uip_ds6_route_add(&dest_ipaddr, 128, &child_ipaddr);
+  UNIT_TEST_ASSERT(child_route != NULL);
+  unicast_traffic_aware.child_added(&child_addr);
+
+  UNIT_TEST_ASSERT(count_links(LINK_OPTION_RX) == ORCHESTRA_TRAFFIC_MAX_CELLS);
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    UNIT_TEST_ASSERT(listens_at(&linkaddr_node_addr, l->timeslot));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(unknown, "No cells to a parent before it knows us");
+UNIT_TEST(unknown)
+{
+  uint16_t slotframe, timeslot;
+
+  UNIT_TEST_BEGIN();
+
+  unicast_traffic_aware.new_time_source(NULL, tsch_queue_add_nbr(&parent_addr));
+  orchestra_parent_knows_us = 0;
+  UNIT_TEST_ASSERT(tsch_queue_add_packet(&parent_addr, NULL, NULL) != NULL);
+  UNIT_TEST_ASSERT(select_to_parent(UIP_PROTO_UDP, &slotframe, &timeslot) == 0);
+  UNIT_TEST_ASSERT(count_links(LINK_OPTION_TX) == 0);
+
+  /* The next DAO to it is ACKed */
+  orchestra_parent_knows_us = 1;
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(tx, "Cells to the parent only where it listens");
+UNIT_TEST(tx)
+{
+  uint16_t slotframe, timeslot;
+  struct tsch_link *l;
+
+  UNIT_TEST_BEGIN();
+
+  /* The queue to the parent added cells up to the maximum */
+  UNIT_TEST_ASSERT(count_links(LINK_OPTION_TX) == ORCHESTRA_TRAFFIC_MAX_CELLS);
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options & LINK_OPTION_TX) {
+      UNIT_TEST_ASSERT(linkaddr_cmp(&l->addr, &parent_addr));
+      UNIT_TEST_ASSERT(listens_at(&parent_addr, l->timeslot));
+    }
+  }
+
+  /* Data packets may use any link to the parent, RPL control packets are
+   * left to the next rules */
+  UNIT_TEST_ASSERT(select_to_parent(UIP_PROTO_UDP, &slotframe, &timeslot) == 1);
+  UNIT_TEST_ASSERT(slotframe == 0xffff && timeslot == 0xffff);
+  UNIT_TEST_ASSERT(select_to_parent(UIP_PROTO_ICMP6, &slotframe, &timeslot) == 0);
+
+  /* Without children, only the cells to the parent are left */
+  uip_ds6_route_rm(child_route);
+  unicast_traffic_aware.child_removed(&child_addr);
+  UNIT_TEST_ASSERT(count_links(LINK_OPTION_RX) == 0);
+  UNIT_TEST_ASSERT(count_links(LINK_OPTION_TX) == ORCHESTRA_TRAFFIC_MAX_CELLS);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  /* Two neighbors whose cells do not overlap ours */
+  linkaddr_copy(&parent_addr, &linkaddr_node_addr);
+  parent_addr.u8[LINKADDR_SIZE - 1]++;
+  linkaddr_copy(&child_addr, &linkaddr_node_addr);
+  child_addr.u8[LINKADDR_SIZE - 1] += 2;
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(rx);
+  UNIT_TEST_RUN(unknown);
+
+  /* One packet stays queued to the parent, TSCH is not associated. With
+   * zero thresholds, a cell is added at every interval. */
+  etimer_set(&et, (ORCHESTRA_TRAFFIC_MAX_CELLS + 1) * ORCHESTRA_TRAFFIC_INTERVAL
+             + ORCHESTRA_TRAFFIC_INTERVAL / 2);
+  PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+  UNIT_TEST_RUN(tx);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "net/linkaddr.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "tsch-queue.c index test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NBRS 4
+
+static linkaddr_t nbr_addr[NBRS];
+static struct tsch_link shared_link;
+
+/*---------------------------------------------------------------------------*/
+/* The neighbor whose packet would go in the next shared slot */
+static struct tsch_neighbor *
+shared_slot_nbr(void)
+{
+  struct tsch_neighbor *n = NULL;
+  if(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) == NULL) {
+    return NULL;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(lookup, "Neighbors are found by address");
+UNIT_TEST(lookup)
+{
+  struct tsch_neighbor *n[NBRS];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Built with TSCH_QUEUE_CONF_WITH_INDEX=1 */
+  UNIT_TEST_ASSERT(TSCH_QUEUE_WITH_INDEX);
+
+  for(i = 0; i < NBRS; i++) {
+    nbr_addr[i].u8[0] = 0x02;
+    nbr_addr[i].u8[LINKADDR_SIZE - 1] = i + 1;
+    n[i] = tsch_queue_add_nbr(&nbr_addr[i]);
+    UNIT_TEST_ASSERT(n[i] != NULL);
+  }
+  for(i = 0; i < NBRS; i++) {
+    UNIT_TEST_ASSERT(tsch_queue_get_nbr(&nbr_addr[i]) == n[i]);
+  }
+  UNIT_TEST_ASSERT(tsch_queue_get_nbr(&tsch_broadcast_address) == n_broadcast);
+  UNIT_TEST_ASSERT(tsch_queue_get_nbr(&tsch_eb_address) == n_eb);
+
+  /* Neighbors with an empty queue and no link are freed */
+  tsch_queue_free_unused_neighbors();
+  for(i = 0; i < NBRS; i++) {
+    UNIT_TEST_ASSERT(tsch_queue_get_nbr(&nbr_addr[i]) == NULL);
+  }
+  UNIT_TEST_ASSERT(tsch_queue_get_nbr(&tsch_broadcast_address) == n_broadcast);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(shared, "Shared slots pick neighbors out of backoff");
+UNIT_TEST(shared)
+{
+  struct tsch_neighbor *n;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  shared_link.link_options = LINK_OPTION_TX | LINK_OPTION_SHARED;
+  linkaddr_copy(&shared_link.addr, &tsch_broadcast_address);
+  UNIT_TEST_ASSERT(shared_slot_nbr() == NULL);
+
+  /* A queued packet makes its neighbor eligible */
+  UNIT_TEST_ASSERT(tsch_queue_add_packet(&nbr_addr[2], NULL, NULL) != NULL);
+  n = tsch_queue_get_nbr(&nbr_addr[2]);
+  UNIT_TEST_ASSERT(n != NULL);
+  UNIT_TEST_ASSERT(shared_slot_nbr() == n);
+
+  /* Not while in backoff, again once the window is over */
+  tsch_queue_backoff_inc(n);
+  UNIT_TEST_ASSERT(shared_slot_nbr() == NULL);
+  for(i = 0; i < 256 && !tsch_queue_backoff_expired(n); i++) {
+    tsch_queue_update_all_backoff_windows(&tsch_broadcast_address);
+  }
+  UNIT_TEST_ASSERT(tsch_queue_backoff_expired(n));
+  UNIT_TEST_ASSERT(shared_slot_nbr() == n);
+
+  /* Not while there is a Tx link to the neighbor */
+  sf = tsch_schedule_add_slotframe(7, 11);
+  UNIT_TEST_ASSERT(sf != NULL);
+  l = tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, &nbr_addr[2], 3, 0);
+  UNIT_TEST_ASSERT(l != NULL);
+  UNIT_TEST_ASSERT(shared_slot_nbr() == NULL);
+  UNIT_TEST_ASSERT(tsch_schedule_remove_slotframe(sf));
+  UNIT_TEST_ASSERT(shared_slot_nbr() == n);
+
+  /* Not once its queue is empty */
+  tsch_queue_free_packet(tsch_queue_remove_packet_from_queue(n));
+  UNIT_TEST_ASSERT(shared_slot_nbr() == NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lookup);
+  UNIT_TEST_RUN(shared);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2016, Georgios Exarchakos
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/linkaddr.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-schedule.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "tsch-schedule.c index test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define SLOTFRAMES 4
+#define LINKS_PER_SLOTFRAME (TSCH_SCHEDULE_MAX_LINKS / SLOTFRAMES)
+#define ASN_STEPS 2000
+#define BENCH_LOOKUPS 256
+
+static const uint16_t sizes[SLOTFRAMES] = { 7, 17, 31, 101 };
+static struct tsch_slotframe *sf[SLOTFRAMES];
+static linkaddr_t nbr_addr = {{ 0x02 }};
+
+/*---------------------------------------------------------------------------*/
+/* Reference: the scan of every slotframe and link of the unindexed schedule */
+static struct tsch_link *
+scan_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
+                      struct tsch_link **backup_link)
+{
+  uint16_t time_to_curr_best = 0;
+  struct tsch_link *curr_best = NULL;
+  struct tsch_link *curr_backup = NULL;
+  int i;
+
+  for(i = 0; i < SLOTFRAMES; i++) {
+    uint16_t timeslot = TSCH_ASN_MOD(*asn, sf[i]->size);
+    struct tsch_link *l;
+    for(l = list_head(sf[i]->links_list); l != NULL; l = list_item_next(l)) {
+      uint16_t time_to_timeslot =
+        l->timeslot > timeslot ?
+        l->timeslot - timeslot :
+        sf[i]->size.val + l->timeslot - timeslot;
+      if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
+        time_to_curr_best = time_to_timeslot;
+        curr_best = l;
+        curr_backup = NULL;
+      } else if(time_to_timeslot == time_to_curr_best) {
+        struct tsch_link *new_best = NULL;
+        if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+          if(l->slotframe_handle < curr_best->slotframe_handle) {
+            new_best = l;
+          }
+        } else if(l->link_options & LINK_OPTION_TX) {
+          new_best = l;
+        }
+        if(curr_backup == NULL) {
+          if(new_best != l && (l->link_options & LINK_OPTION_RX)) {
+            curr_backup = l;
+          }
+          if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) {
+            curr_backup = curr_best;
+          }
+        }
+        if(new_best != NULL) {
+          curr_best = new_best;
+        }
+      }
+    }
+  }
+  *time_offset = time_to_curr_best;
+  *backup_link = curr_backup;
+  return curr_best;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+random_options(void)
+{
+  switch(random_rand() % 3) {
+  case 0:
+    return LINK_OPTION_TX;
+  case 1:
+    return LINK_OPTION_RX;
+  default:
+    return LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_link *
+add_random_link(int i)
+{
+  uint8_t options = random_options();
+  return tsch_schedule_add_link(sf[i], options, LINK_TYPE_NORMAL,
+                                (options & LINK_OPTION_SHARED) ? &tsch_broadcast_address : &nbr_addr,
+                                random_rand() % sizes[i], 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 1 if the schedule answers like the scan for ASN_STEPS slots */
+static int
+matches_scan(void)
+{
+  struct tsch_asn_t asn;
+  int i;
+
+  TSCH_ASN_INIT(asn, 0, 0xffffffff - ASN_STEPS / 2);
+  for(i = 0; i < ASN_STEPS; i++) {
+    uint16_t offset, scan_offset;
+    struct tsch_link *backup, *scan_backup;
+    struct tsch_link *l = tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    struct tsch_link *scan = scan_next_active_link(&asn, &scan_offset, &scan_backup);
+    if(l != scan || backup != scan_backup || (l != NULL && offset != scan_offset)) {
+      printf("mismatch at asn %02x.%08lx\n", asn.ms1b, (unsigned long)asn.ls4b);
+      return 0;
+    }
+    TSCH_ASN_INC(asn, 1);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(lookup, "Next active link matches a scan of all links");
+UNIT_TEST(lookup)
+{
+  struct tsch_asn_t asn;
+  uint16_t offset;
+  struct tsch_link *backup;
+  int i, j;
+
+  UNIT_TEST_BEGIN();
+
+  /* Built with TSCH_SCHEDULE_CONF_WITH_INDEX=1 */
+  UNIT_TEST_ASSERT(TSCH_SCHEDULE_WITH_INDEX);
+
+  tsch_schedule_remove_all_slotframes();
+  for(i = 0; i < SLOTFRAMES; i++) {
+    sf[i] = tsch_schedule_add_slotframe(i, sizes[i]);
+    UNIT_TEST_ASSERT(sf[i] != NULL);
+  }
+
+  /* Empty schedule */
+  TSCH_ASN_INIT(asn, 0, 0);
+  UNIT_TEST_ASSERT(tsch_schedule_get_next_active_link(&asn, &offset, &backup) == NULL);
+
+  /* A single link is next one full slotframe later when it is current */
+  UNIT_TEST_ASSERT(tsch_schedule_add_link(sf[3], LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                                          &nbr_addr, 0, 0) != NULL);
+  UNIT_TEST_ASSERT(tsch_schedule_get_next_active_link(&asn, &offset, &backup) != NULL);
+  UNIT_TEST_ASSERT(offset == sizes[3]);
+
+  /* Links at random timeslots, some of them overlapping across slotframes */
+  for(i = 0; i < SLOTFRAMES; i++) {
+    for(j = 0; j < LINKS_PER_SLOTFRAME - 1; j++) {
+      add_random_link(i);
+    }
+  }
+  UNIT_TEST_ASSERT(matches_scan());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(update, "Index follows link additions and removals");
+UNIT_TEST(update)
+{
+  struct tsch_link *l;
+  uint16_t timeslot;
+  int i, j, k;
+
+  UNIT_TEST_BEGIN();
+
+  for(j = 0; j < 16; j++) {
+    i = random_rand() % SLOTFRAMES;
+    /* Remove a random link, then add one, possibly replacing another */
+    l = list_head(sf[i]->links_list);
+    for(k = random_rand() % list_length(sf[i]->links_list); k > 0; k--) {
+      l = list_item_next(l);
+    }
+    timeslot = l->timeslot;
+    UNIT_TEST_ASSERT(tsch_schedule_remove_link(sf[i], l));
+    UNIT_TEST_ASSERT(tsch_schedule_get_link_by_timeslot(sf[i], timeslot) == NULL);
+    l = add_random_link(i);
+    UNIT_TEST_ASSERT(l != NULL);
+    UNIT_TEST_ASSERT(tsch_schedule_get_link_by_timeslot(sf[i], l->timeslot) == l);
+    UNIT_TEST_ASSERT(matches_scan());
+  }
+
+  /* Empty a slotframe in the middle of the list, replace the last one */
+  while((l = list_head(sf[1]->links_list)) != NULL) {
+    UNIT_TEST_ASSERT(tsch_schedule_remove_link(sf[1], l));
+  }
+  UNIT_TEST_ASSERT(matches_scan());
+  UNIT_TEST_ASSERT(tsch_schedule_remove_slotframe(sf[3]));
+  sf[3] = tsch_schedule_add_slotframe(3, sizes[3]);
+  UNIT_TEST_ASSERT(sf[3] != NULL);
+  for(j = 0; j < LINKS_PER_SLOTFRAME; j++) {
+    UNIT_TEST_ASSERT(add_random_link(1) != NULL);
+    UNIT_TEST_ASSERT(add_random_link(3) != NULL);
+  }
+  UNIT_TEST_ASSERT(matches_scan());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(void)
+{
+  struct tsch_asn_t asn;
+  uint16_t offset;
+  struct tsch_link *backup;
+  rtimer_clock_t start, t_scan, t_index;
+  int i;
+
+  TSCH_ASN_INIT(asn, 0, 0);
+  start = RTIMER_NOW();
+  for(i = 0; i < BENCH_LOOKUPS; i++) {
+    scan_next_active_link(&asn, &offset, &backup);
+    TSCH_ASN_INC(asn, 1);
+  }
+  t_scan = RTIMER_NOW() - start;
+
+  TSCH_ASN_INIT(asn, 0, 0);
+  start = RTIMER_NOW();
+  for(i = 0; i < BENCH_LOOKUPS; i++) {
+    tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    TSCH_ASN_INC(asn, 1);
+  }
+  t_index = RTIMER_NOW() - start;
+
+  printf("schedule-bench: %d lookups, scan %u, index %u rtimer ticks\n",
+         BENCH_LOOKUPS, (unsigned)t_scan, (unsigned)t_index);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lookup);
+  UNIT_TEST_RUN(update);
+  bench();
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}